@@ -0,0 +1,3 @@
+#include "gdwg_algorithm.h"
+
+using namespace gdwg;
@@ -0,0 +1,1810 @@
+#ifndef GDWG_ALGORITHM_H
+#define GDWG_ALGORITHM_H
+
+#include "gdwg_graph.h"
+
+#include <algorithm>
+#include <atomic>
+#include <barrier>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <exception>
+#include <limits>
+#include <map>
+#include <numeric>
+#include <optional>
+#include <ranges>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Graph algorithms. Every algorithm runs over a csr_graph, so results are dense arrays
+// keyed by the snapshot's node ids. The gdwg::graph overloads freeze the graph first,
+// freeze once yourself when running several queries over the same graph.
+
+namespace gdwg {
+	// how an edge without a weight counts in a weighted algorithm
+	enum class unweighted_policy {
+		skip, // the edge is ignored
+		zero, // the edge costs E{}
+		unit, // the edge costs E{1}, one hop
+	};
+
+	// a path between two nodes and the sum of its edge weights
+	template<typename N, typename E>
+	struct weighted_path {
+		std::vector<N> nodes;
+		E weight;
+	};
+
+	namespace detail {
+		inline constexpr node_id no_parent = std::numeric_limits<node_id>::max();
+
+		// cost of one edge under the policy, nullopt when it is skipped
+		template<typename E>
+		auto edge_cost(std::optional<E> const& weight, unweighted_policy policy) -> std::optional<E> {
+			if (weight) {
+				return weight;
+			}
+			switch (policy) {
+			case unweighted_policy::zero: return E{};
+			case unweighted_policy::unit: return E{1};
+			case unweighted_policy::skip: break;
+			}
+			return std::nullopt;
+		}
+
+		// call f(dst, cost) once per distinct target with the cheapest of its parallel edges.
+		// Runs are contiguous in csr order, so this is one linear walk.
+		template<typename E, typename F>
+		auto for_each_min_edge(std::span<node_id const> targets,
+		                       std::span<std::optional<E> const> weights,
+		                       unweighted_policy policy,
+		                       F f) -> void {
+			for (auto i = std::size_t{0}; i < targets.size();) {
+				auto const dst = targets[i];
+				auto best = std::optional<E>();
+				for (; i < targets.size() && targets[i] == dst; ++i) {
+					auto const cost = edge_cost(weights[i], policy);
+					if (cost && (!best || *cost < *best)) {
+						best = cost;
+					}
+				}
+				if (best) {
+					f(dst, *best);
+				}
+			}
+		}
+
+		// 4-ary min heap over node ids with decrease-key. Keys live next to the ids in
+		// one array, so sifting touches a single cache line per level.
+		template<typename K>
+		class indexed_heap {
+		 public:
+			explicit indexed_heap(std::size_t node_count)
+			: pos_(node_count, npos) {}
+
+			[[nodiscard]] auto empty() const -> bool {
+				return heap_.empty();
+			}
+
+			[[nodiscard]] auto size() const -> std::size_t {
+				return heap_.size();
+			}
+
+			// smallest key, the heap must not be empty
+			[[nodiscard]] auto top() const -> K const& {
+				return heap_.front().key;
+			}
+
+			// insert id, or lower its key, returns false when the key would not decrease
+			auto push(node_id id, K const& key) -> bool {
+				auto i = pos_[id];
+				if (i == npos) {
+					i = heap_.size();
+					heap_.push_back(entry{key, id});
+				}
+				else if (key < heap_[i].key) {
+					heap_[i].key = key;
+				}
+				else {
+					return false;
+				}
+				sift_up(i);
+				return true;
+			}
+
+			auto pop() -> std::pair<node_id, K> {
+				auto const top = heap_.front();
+				pos_[top.id] = npos;
+				heap_.front() = heap_.back();
+				heap_.pop_back();
+				if (!heap_.empty()) {
+					sift_down(0);
+				}
+				return {top.id, top.key};
+			}
+
+			// empty the heap for ids below node_count, O(queued) when the count is unchanged
+			auto reset(std::size_t node_count) -> void {
+				if (pos_.size() != node_count) {
+					pos_.assign(node_count, npos);
+				}
+				else {
+					for (auto const& e : heap_) {
+						pos_[e.id] = npos;
+					}
+				}
+				heap_.clear();
+			}
+
+		 private:
+			struct entry {
+				K key;
+				node_id id;
+			};
+			static constexpr std::size_t arity = 4;
+			static constexpr std::size_t npos = std::numeric_limits<std::size_t>::max();
+
+			std::vector<entry> heap_;
+			// id -> slot in heap_, npos when not queued
+			std::vector<std::size_t> pos_;
+
+			auto sift_up(std::size_t i) -> void {
+				auto const e = heap_[i];
+				while (i > 0) {
+					auto const parent = (i - 1) / arity;
+					if (!(e.key < heap_[parent].key)) {
+						break;
+					}
+					place(i, heap_[parent]);
+					i = parent;
+				}
+				place(i, e);
+			}
+
+			auto sift_down(std::size_t i) -> void {
+				auto const e = heap_[i];
+				while (true) {
+					auto const first = i * arity + 1;
+					if (first >= heap_.size()) {
+						break;
+					}
+					auto const last = std::min(first + arity, heap_.size());
+					auto best = first;
+					for (auto c = first + 1; c < last; ++c) {
+						if (heap_[c].key < heap_[best].key) {
+							best = c;
+						}
+					}
+					if (!(heap_[best].key < e.key)) {
+						break;
+					}
+					place(i, heap_[best]);
+					i = best;
+				}
+				place(i, e);
+			}
+
+			auto place(std::size_t i, entry const& e) -> void {
+				heap_[i] = e;
+				pos_[e.id] = i;
+			}
+		};
+
+		// dense distance and parent arrays, keyed by csr node id
+		template<typename E>
+		struct search_state {
+			std::vector<std::optional<E>> distance;
+			std::vector<node_id> parent;
+		};
+
+		// one direction of a point to point search. The arrays stay sized to the graph
+		// between searches and only the ids the last search reached are cleared.
+		template<typename E>
+		struct search_side {
+			std::vector<std::optional<E>> distance;
+			std::vector<node_id> parent;
+			std::vector<bool> settled;
+			indexed_heap<E> queue = indexed_heap<E>(0);
+			// ids whose distance is set
+			std::vector<node_id> touched;
+
+			// clear the last search and queue start with key
+			auto start(std::size_t node_count, node_id from, E const& key) -> void {
+				if (distance.size() != node_count) {
+					distance.assign(node_count, std::nullopt);
+					parent.assign(node_count, no_parent);
+					settled.assign(node_count, false);
+				}
+				else {
+					for (auto const id : touched) {
+						distance[id] = std::nullopt;
+						parent[id] = no_parent;
+						settled[id] = false;
+					}
+				}
+				touched.clear();
+				queue.reset(node_count);
+				reach(from, E{}, no_parent);
+				queue.push(from, key);
+			}
+
+			auto reach(node_id id, E const& d, node_id from) -> void {
+				if (!distance[id]) {
+					touched.push_back(id);
+				}
+				distance[id] = d;
+				parent[id] = from;
+			}
+		};
+
+		// reaches the sides of a search_workspace, defined after it
+		struct workspace_access;
+
+		template<typename E>
+		auto require_non_negative(E const& w, char const* fn) -> void {
+			if (w < E{}) {
+				throw std::runtime_error(std::string("Cannot call gdwg::") + fn
+				                         + " on a graph with a negative edge weight");
+			}
+		}
+
+		// Dijkstra from source, stops as soon as target is settled when one is given
+		template<typename N, typename E>
+		auto dijkstra(csr_graph<N, E> const& g, node_id source, std::optional<node_id> target, unweighted_policy policy)
+		    -> search_state<E> {
+			auto state = search_state<E>{std::vector<std::optional<E>>(g.node_count()),
+			                             std::vector<node_id>(g.node_count(), no_parent)};
+			auto settled = std::vector<bool>(g.node_count());
+			auto queue = indexed_heap<E>(g.node_count());
+			state.distance[source] = E{};
+			queue.push(source, E{});
+			while (!queue.empty()) {
+				auto const [u, du] = queue.pop();
+				settled[u] = true;
+				if (target && u == *target) {
+					break;
+				}
+				for_each_min_edge(g.out_targets(u), g.out_weights(u), policy, [&](node_id v, E const& w) {
+					require_non_negative(w, "shortest_paths");
+					if (settled[v]) {
+						return;
+					}
+					auto const dv = du + w;
+					if (queue.push(v, dv)) {
+						state.distance[v] = dv;
+						state.parent[v] = u;
+					}
+				});
+			}
+			return state;
+		}
+
+		// Dijkstra from both ends at once, the backward search walks the transposed
+		// adjacency. Stops once the two queue minimums together can't beat the best meeting.
+		template<typename N, typename E>
+		auto bidirectional_dijkstra(csr_graph<N, E> const& g,
+		                            node_id src,
+		                            node_id dst,
+		                            search_side<E>& fwd,
+		                            search_side<E>& bwd,
+		                            unweighted_policy policy) -> std::optional<weighted_path<N, E>> {
+			fwd.start(g.node_count(), src, E{});
+			bwd.start(g.node_count(), dst, E{});
+			auto best = std::optional<E>();
+			auto meet = no_parent;
+			if (src == dst) {
+				best = E{};
+				meet = src;
+			}
+
+			// settle one node of self and relax its edges, forward or transposed
+			auto step = [&](search_side<E>& self, search_side<E> const& other, bool forward) {
+				auto const [u, du] = self.queue.pop();
+				self.settled[u] = true;
+				auto const targets = forward ? g.out_targets(u) : g.in_sources(u);
+				auto const weights = forward ? g.out_weights(u) : g.in_weights(u);
+				for_each_min_edge(targets, weights, policy, [&](node_id v, E const& w) {
+					require_non_negative(w, "bidirectional_shortest_path");
+					if (!self.settled[v] && self.queue.push(v, du + w)) {
+						self.reach(v, du + w, u);
+					}
+					// both searches have reached v, join them there
+					if (other.distance[v]) {
+						auto const total = *self.distance[v] + *other.distance[v];
+						if (!best || total < *best) {
+							best = total;
+							meet = v;
+						}
+					}
+				});
+			};
+
+			while (!fwd.queue.empty() && !bwd.queue.empty()) {
+				if (best && !(fwd.queue.top() + bwd.queue.top() < *best)) {
+					break;
+				}
+				// grow the smaller frontier
+				if (fwd.queue.size() <= bwd.queue.size()) {
+					step(fwd, bwd, true);
+				}
+				else {
+					step(bwd, fwd, false);
+				}
+			}
+			if (!best) {
+				return std::nullopt;
+			}
+			auto at = [&](node_id n) { return g.node_at(n); };
+			auto nodes = unwind<N>(fwd.parent, meet, at);
+			for (auto n = bwd.parent[meet]; n != no_parent; n = bwd.parent[n]) {
+				nodes.push_back(at(n));
+			}
+			return weighted_path<N, E>{std::move(nodes), *best};
+		}
+
+		// A* from src to dst, h(node) must never overestimate the distance left to dst.
+		// A node may be reopened when a cheaper path turns up, so h need not be consistent.
+		template<typename N, typename E, typename H>
+		auto astar(csr_graph<N, E> const& g, node_id src, node_id dst, H& h, search_side<E>& side, unweighted_policy policy)
+		    -> std::optional<weighted_path<N, E>> {
+			side.start(g.node_count(), src, h(g.node_at(src)));
+			while (!side.queue.empty()) {
+				auto const u = side.queue.pop().first;
+				if (u == dst) {
+					auto nodes = unwind<N>(side.parent, dst, [&](node_id n) { return g.node_at(n); });
+					return weighted_path<N, E>{std::move(nodes), *side.distance[dst]};
+				}
+				auto const du = *side.distance[u];
+				for_each_min_edge(g.out_targets(u), g.out_weights(u), policy, [&](node_id v, E const& w) {
+					require_non_negative(w, "astar_shortest_path");
+					auto const dv = du + w;
+					if (!side.distance[v] || dv < *side.distance[v]) {
+						side.reach(v, dv, u);
+						side.queue.push(v, dv + h(g.node_at(v)));
+					}
+				});
+			}
+			return std::nullopt;
+		}
+
+		// node values from the root of the parent links to node
+		template<typename N, typename At>
+		auto unwind(std::span<node_id const> parent, node_id node, At at) -> std::vector<N> {
+			auto path = std::vector<N>();
+			for (auto id = node; id != no_parent; id = parent[id]) {
+				path.push_back(at(id));
+			}
+			std::reverse(path.begin(), path.end());
+			return path;
+		}
+
+		// Threads for one algorithm run. They start with the first parallel step and wait
+		// on a barrier between steps, so a search of many levels or rounds starts its
+		// threads once instead of once a step. A step given one worker runs inline.
+		class worker_pool {
+		 public:
+			explicit worker_pool(unsigned threads)
+			: size_(std::max(threads, 1u))
+			, step_(static_cast<std::ptrdiff_t>(size_))
+			, errors_(size_) {}
+
+			worker_pool(worker_pool const&) = delete;
+			auto operator=(worker_pool const&) -> worker_pool& = delete;
+
+			~worker_pool() {
+				if (!threads_.empty()) {
+					stop_ = true;
+					step_.arrive_and_wait();
+					for (auto& t : threads_) {
+						t.join();
+					}
+				}
+			}
+
+			// run f(begin, end, worker) over [0, n) split into one contiguous chunk per
+			// worker, at most threads of them, the calling thread takes the first chunk.
+			// Rethrows the first worker exception.
+			template<typename F>
+			auto parallel_for(std::size_t n, unsigned threads, F const& f) -> void {
+				auto const workers = std::min({std::size_t{threads}, std::size_t{size_}, n});
+				if (workers <= 1) {
+					f(std::size_t{0}, n, std::size_t{0});
+					return;
+				}
+				if (threads_.empty()) {
+					for (auto w = std::size_t{1}; w < size_; ++w) {
+						threads_.emplace_back([this, w] { work(w); });
+					}
+				}
+				// read by the workers once they pass the barrier
+				job_ = &f;
+				call_ = [](void const* job, std::size_t first, std::size_t last, std::size_t w) {
+					(*static_cast<F const*>(job))(first, last, w);
+				};
+				n_ = n;
+				workers_ = workers;
+				step_.arrive_and_wait();
+				run(0);
+				step_.arrive_and_wait();
+				for (auto& e : errors_) {
+					if (e) {
+						std::rethrow_exception(std::exchange(e, nullptr));
+					}
+				}
+			}
+
+		 private:
+			std::size_t size_;
+			std::barrier<> step_;
+			std::vector<std::exception_ptr> errors_;
+			std::vector<std::thread> threads_;
+			// the current step, see parallel_for
+			void const* job_ = nullptr;
+			void (*call_)(void const*, std::size_t, std::size_t, std::size_t) = nullptr;
+			std::size_t n_ = 0;
+			std::size_t workers_ = 0;
+			bool stop_ = false;
+
+			auto run(std::size_t w) -> void {
+				if (w >= workers_) {
+					return;
+				}
+				auto const chunk = (n_ + workers_ - 1) / workers_;
+				try {
+					call_(job_, std::min(w * chunk, n_), std::min((w + 1) * chunk, n_), w);
+				} catch (...) {
+					errors_[w] = std::current_exception();
+				}
+			}
+
+			// each step is a start and an end barrier, the pool's destructor sends a last start
+			auto work(std::size_t w) -> void {
+				for (;;) {
+					step_.arrive_and_wait();
+					if (stop_) {
+						return;
+					}
+					run(w);
+					step_.arrive_and_wait();
+				}
+			}
+		};
+
+		// one bit per node id
+		class bitmap {
+		 public:
+			static constexpr std::size_t word_bits = 64;
+
+			explicit bitmap(std::size_t bits)
+			: words_((bits + word_bits - 1) / word_bits) {}
+
+			[[nodiscard]] auto test(std::size_t i) const -> bool {
+				return (words_[i / word_bits] >> (i % word_bits) & 1) != 0;
+			}
+
+			auto set(std::size_t i) -> void {
+				words_[i / word_bits] |= std::uint64_t{1} << (i % word_bits);
+			}
+
+			// set from several threads at once
+			auto set_atomic(std::size_t i) -> void {
+				std::atomic_ref(words_[i / word_bits]).fetch_or(std::uint64_t{1} << (i % word_bits),
+				                                                std::memory_order_relaxed);
+			}
+
+			[[nodiscard]] auto word_count() const -> std::size_t {
+				return words_.size();
+			}
+
+			[[nodiscard]] auto word(std::size_t w) const -> std::uint64_t {
+				return words_[w];
+			}
+
+			// call f(i) for every set bit in words [first, last), ascending
+			template<typename F>
+			auto for_each(std::size_t first, std::size_t last, F f) const -> void {
+				for (auto w = first; w < last; ++w) {
+					for (auto bits = words_[w]; bits != 0; bits &= bits - 1) {
+						f(w * word_bits + static_cast<std::size_t>(std::countr_zero(bits)));
+					}
+				}
+			}
+
+			auto clear() -> void {
+				std::fill(words_.begin(), words_.end(), std::uint64_t{0});
+			}
+
+			auto swap(bitmap& other) noexcept -> void {
+				words_.swap(other.words_);
+			}
+
+		 private:
+			std::vector<std::uint64_t> words_;
+		};
+
+		inline constexpr std::uint32_t unreached = std::numeric_limits<std::uint32_t>::max();
+
+		// Level synchronous BFS with a bitmap frontier (Beamer's direction optimizing
+		// search). Small frontiers push along out edges (top-down). Once the frontier's
+		// edges outnumber a fraction of the unexplored ones, every unvisited node pulls
+		// from its in edges instead and stops at the first parent found (bottom-up).
+		template<typename N, typename E>
+		auto bfs(csr_graph<N, E> const& g, std::span<node_id const> seeds, unsigned threads)
+		    -> std::pair<std::vector<std::uint32_t>, std::vector<node_id>> {
+			constexpr auto alpha = std::size_t{14};
+			constexpr auto beta = std::size_t{24};
+			// below this many frontier edges a level is not worth the threads
+			constexpr auto parallel_edges = std::size_t{1} << 14;
+
+			auto const n = g.node_count();
+			auto levels = std::vector<std::uint32_t>(n, unreached);
+			auto order = std::vector<node_id>();
+			auto frontier = bitmap(n);
+			auto next = bitmap(n);
+			auto const words = frontier.word_count();
+			auto pool = worker_pool(threads);
+			auto degree = [&](std::size_t u) { return g.out_targets(static_cast<node_id>(u)).size(); };
+
+			auto frontier_count = std::size_t{0};
+			auto frontier_edges = std::size_t{0};
+			auto unexplored_edges = g.edge_count();
+			for (auto const s : seeds) {
+				if (levels[s] == unreached) {
+					levels[s] = 0;
+					frontier.set(s);
+					++frontier_count;
+					frontier_edges += degree(s);
+				}
+			}
+			frontier.for_each(0, frontier.word_count(), [&](std::size_t u) { order.push_back(static_cast<node_id>(u)); });
+			unexplored_edges -= frontier_edges;
+
+			auto bottom_up = false;
+			for (auto level = std::uint32_t{0}; frontier_count > 0; ++level) {
+				if (!bottom_up && frontier_edges > unexplored_edges / alpha) {
+					bottom_up = true;
+				}
+				else if (bottom_up && frontier_count < n / beta) {
+					bottom_up = false;
+				}
+				auto const workers = frontier_edges < parallel_edges ? 1u : std::max(threads, 1u);
+				auto counts = std::vector<std::size_t>(workers);
+				auto edges = std::vector<std::size_t>(workers);
+
+				if (bottom_up) {
+					// each worker owns whole words of next, so plain writes are safe
+					pool.parallel_for(words, workers, [&](std::size_t first, std::size_t last, std::size_t w) {
+						for (auto v = first * bitmap::word_bits; v < std::min(last * bitmap::word_bits, n); ++v) {
+							if (levels[v] != unreached) {
+								continue;
+							}
+							for (auto const u : g.in_sources(static_cast<node_id>(v))) {
+								if (frontier.test(u)) {
+									levels[v] = level + 1;
+									next.set(v);
+									++counts[w];
+									edges[w] += degree(v);
+									break;
+								}
+							}
+						}
+					});
+				}
+				else {
+					// targets are claimed with a compare and swap on their level
+					pool.parallel_for(words, workers, [&](std::size_t first, std::size_t last, std::size_t w) {
+						frontier.for_each(first, last, [&](std::size_t u) {
+							for (auto const v : g.out_targets(static_cast<node_id>(u))) {
+								auto level_ref = std::atomic_ref(levels[v]);
+								auto expected = unreached;
+								if (level_ref.load(std::memory_order_relaxed) == unreached
+								    && level_ref.compare_exchange_strong(expected, level + 1, std::memory_order_relaxed))
+								{
+									next.set_atomic(v);
+									++counts[w];
+									edges[w] += degree(v);
+								}
+							}
+						});
+					});
+				}
+
+				next.for_each(0, next.word_count(), [&](std::size_t v) { order.push_back(static_cast<node_id>(v)); });
+				frontier_count = std::accumulate(counts.begin(), counts.end(), std::size_t{0});
+				frontier_edges = std::accumulate(edges.begin(), edges.end(), std::size_t{0});
+				unexplored_edges -= frontier_edges;
+				frontier.swap(next);
+				next.clear();
+			}
+			return {std::move(levels), std::move(order)};
+		}
+
+		// Meyer and Sanders' delta-stepping. Nodes wait in buckets of width delta. The
+		// lowest bucket is emptied by relaxing light edges (weight <= delta) in parallel
+		// until it stays empty, then heavy edges leave its settled nodes once. Distances
+		// are lowered with a compare and swap, so threads never lock.
+		template<typename N, typename E>
+		auto delta_stepping(csr_graph<N, E> const& g, node_id source, E delta, unsigned threads, unweighted_policy policy)
+		    -> search_state<E> {
+			// below this many nodes a relaxation round is not worth the threads
+			constexpr auto parallel_nodes = std::size_t{1024};
+			constexpr auto infinity = std::numeric_limits<E>::max();
+
+			auto const n = g.node_count();
+			auto const workers = std::max(threads, 1u);
+			auto dist = std::vector<E>(n, infinity);
+			auto buckets = std::map<std::size_t, std::vector<node_id>>();
+			auto bucket_of = [&](E d) { return static_cast<std::size_t>(d / delta); };
+			auto improved = std::vector<std::vector<node_id>>(workers);
+			auto pool = worker_pool(workers);
+
+			// relax the light or the heavy edges leaving every node in from
+			auto relax = [&](std::vector<node_id> const& from, bool light) {
+				auto const round_workers = from.size() < parallel_nodes ? 1u : workers;
+				pool.parallel_for(from.size(), round_workers, [&](std::size_t first, std::size_t last, std::size_t w) {
+					for (auto i = first; i < last; ++i) {
+						auto const u = from[i];
+						auto const du = std::atomic_ref(dist[u]).load(std::memory_order_relaxed);
+						for_each_min_edge(g.out_targets(u), g.out_weights(u), policy, [&](node_id v, E const& weight) {
+							require_non_negative(weight, "delta_stepping");
+							if ((weight <= delta) != light) {
+								return;
+							}
+							auto const dv = du + weight;
+							auto dist_ref = std::atomic_ref(dist[v]);
+							auto current = dist_ref.load(std::memory_order_relaxed);
+							while (dv < current) {
+								if (dist_ref.compare_exchange_weak(current, dv, std::memory_order_relaxed)) {
+									improved[w].push_back(v);
+									break;
+								}
+							}
+						});
+					}
+				});
+				for (auto& list : improved) {
+					for (auto const v : list) {
+						buckets[bucket_of(dist[v])].push_back(v);
+					}
+					list.clear();
+				}
+			};
+
+			// marks a node as taken in the current pass, so each pass relaxes it once
+			auto stamp = std::vector<std::size_t>(n);
+			auto pass = std::size_t{0};
+			auto take = [&](node_id v) {
+				if (stamp[v] == pass) {
+					return false;
+				}
+				stamp[v] = pass;
+				return true;
+			};
+
+			dist[source] = E{};
+			buckets[0].push_back(source);
+			while (!buckets.empty()) {
+				auto const current = buckets.begin()->first;
+				auto settled = std::vector<node_id>();
+				// light edges can only refill this bucket or later ones
+				while (!buckets.empty() && buckets.begin()->first == current) {
+					auto round = std::move(buckets.begin()->second);
+					buckets.erase(buckets.begin());
+					++pass;
+					// entries are stale once their node moved to a lower distance
+					std::erase_if(round, [&](node_id v) { return bucket_of(dist[v]) != current || !take(v); });
+					settled.insert(settled.end(), round.begin(), round.end());
+					relax(round, true);
+				}
+				++pass;
+				std::erase_if(settled, [&](node_id v) { return !take(v); });
+				relax(settled, false);
+			}
+
+			// the parent of v is any u on a tight edge, dist[u] + w == dist[v]. Walking tight
+			// edges breadth first from the source gives a tree even through zero weights.
+			auto state = search_state<E>{std::vector<std::optional<E>>(n), std::vector<node_id>(n, no_parent)};
+			auto reached = std::vector<bool>(n);
+			auto queue = std::vector<node_id>{source};
+			reached[source] = true;
+			for (auto head = std::size_t{0}; head < queue.size(); ++head) {
+				auto const u = queue[head];
+				state.distance[u] = dist[u];
+				for_each_min_edge(g.out_targets(u), g.out_weights(u), policy, [&](node_id v, E const& weight) {
+					if (!reached[v] && dist[u] + weight == dist[v]) {
+						reached[v] = true;
+						state.parent[v] = u;
+						queue.push_back(v);
+					}
+				});
+			}
+			return state;
+		}
+
+		// "no path" in a distance matrix. It is never added to, so a cell holds exactly
+		// this value when and only when its dst can't be reached, negative weights or not.
+		template<typename E>
+		constexpr auto matrix_infinity() -> E {
+			if constexpr (std::numeric_limits<E>::has_infinity) {
+				return std::numeric_limits<E>::infinity();
+			}
+			else {
+				return std::numeric_limits<E>::max();
+			}
+		}
+
+		// one Floyd-Warshall tile, rows [i0, i1) and columns [j0, j1) through the pivots
+		// [k0, k1). The j loop is a contiguous min-plus over two rows, which compilers
+		// turn into vector min, add and blend. Unreachable cells are skipped rather than
+		// added, so they stay matrix_infinity and can't overflow.
+		template<typename E>
+		auto min_plus_tile(std::vector<E>& d,
+		                   std::size_t n,
+		                   std::pair<std::size_t, std::size_t> rows,
+		                   std::pair<std::size_t, std::size_t> cols,
+		                   std::pair<std::size_t, std::size_t> pivots) -> void {
+			constexpr auto infinity = matrix_infinity<E>();
+			for (auto k = pivots.first; k < pivots.second; ++k) {
+				auto const* const row_k = d.data() + k * n;
+				for (auto i = rows.first; i < rows.second; ++i) {
+					auto* const row_i = d.data() + i * n;
+					auto const dik = row_i[k];
+					if (dik == infinity) {
+						continue;
+					}
+					for (auto j = cols.first; j < cols.second; ++j) {
+						auto const dkj = row_k[j];
+						auto const through = dkj == infinity ? infinity : static_cast<E>(dik + dkj);
+						row_i[j] = through < row_i[j] ? through : row_i[j];
+					}
+				}
+			}
+		}
+
+		// Blocked Floyd-Warshall. For each pivot block the diagonal tile goes first, then
+		// the tiles sharing its row or column, then every other tile; tiles in the last two
+		// steps are independent, so they are split across threads.
+		template<typename E>
+		auto floyd_warshall(std::vector<E>& d, std::size_t n, unsigned threads) -> void {
+			// 64 x 64 tiles of three rows each fit in L1/L2 together
+			constexpr auto tile = std::size_t{64};
+			auto const tiles = (n + tile - 1) / tile;
+			auto const span_of = [&](std::size_t t) { return std::pair{t * tile, std::min((t + 1) * tile, n)}; };
+			auto const workers = n < 2 * tile ? 1u : std::max(threads, 1u);
+			auto pool = worker_pool(workers);
+			for (auto kt = std::size_t{0}; kt < tiles; ++kt) {
+				auto const pivots = span_of(kt);
+				min_plus_tile(d, n, pivots, pivots, pivots);
+				// tile t < tiles - 1 is in the pivot row, the rest are in the pivot column
+				auto const others = tiles - 1;
+				pool.parallel_for(2 * others, workers, [&](std::size_t first, std::size_t last, std::size_t) {
+					for (auto t = first; t < last; ++t) {
+						auto const other = span_of(t % others < kt ? t % others : t % others + 1);
+						if (t < others) {
+							min_plus_tile(d, n, pivots, other, pivots);
+						}
+						else {
+							min_plus_tile(d, n, other, pivots, pivots);
+						}
+					}
+				});
+				pool.parallel_for(others * others, workers, [&](std::size_t first, std::size_t last, std::size_t) {
+					for (auto t = first; t < last; ++t) {
+						auto const it = t / others < kt ? t / others : t / others + 1;
+						auto const jt = t % others < kt ? t % others : t % others + 1;
+						min_plus_tile(d, n, span_of(it), span_of(jt), pivots);
+					}
+				});
+			}
+		}
+
+		// Tarjan's SCC with an explicit call stack, so deep graphs can't overflow the
+		// native one. Components are numbered in reverse of the order Tarjan finishes
+		// them, which is a topological order of the condensation.
+		template<typename N, typename E>
+		auto tarjan(csr_graph<N, E> const& g) -> std::pair<std::vector<std::uint32_t>, std::uint32_t> {
+			constexpr auto unvisited = std::numeric_limits<std::uint32_t>::max();
+			auto const n = g.node_count();
+			auto index = std::vector<std::uint32_t>(n, unvisited);
+			auto low = std::vector<std::uint32_t>(n);
+			auto on_stack = std::vector<bool>(n);
+			auto stack = std::vector<node_id>();
+			// node and the position of its next out edge to look at
+			auto calls = std::vector<std::pair<node_id, std::size_t>>();
+			auto finished = std::vector<std::uint32_t>(n);
+			auto next_index = std::uint32_t{0};
+			auto count = std::uint32_t{0};
+
+			auto visit = [&](node_id v) {
+				index[v] = low[v] = next_index++;
+				stack.push_back(v);
+				on_stack[v] = true;
+				calls.emplace_back(v, 0);
+			};
+			for (auto root = node_id{0}; root < n; ++root) {
+				if (index[root] != unvisited) {
+					continue;
+				}
+				visit(root);
+				while (!calls.empty()) {
+					auto const [u, e] = calls.back();
+					auto const targets = g.out_targets(u);
+					if (e < targets.size()) {
+						++calls.back().second;
+						auto const v = targets[e];
+						if (index[v] == unvisited) {
+							visit(v);
+						}
+						else if (on_stack[v]) {
+							low[u] = std::min(low[u], index[v]);
+						}
+						continue;
+					}
+					// u is done, it roots a component when nothing below reached above it
+					calls.pop_back();
+					if (low[u] == index[u]) {
+						auto v = node_id{0};
+						do {
+							v = stack.back();
+							stack.pop_back();
+							on_stack[v] = false;
+							finished[v] = count;
+						} while (v != u);
+						++count;
+					}
+					if (!calls.empty()) {
+						auto const parent = calls.back().first;
+						low[parent] = std::min(low[parent], low[u]);
+					}
+				}
+			}
+			for (auto& c : finished) {
+				c = count - 1 - c;
+			}
+			return {std::move(finished), count};
+		}
+
+		// split nodes [0, n) into parts of about equal cost, cost(v) being one for the
+		// node plus its edges. Returns parts + 1 boundaries.
+		template<typename Cost>
+		auto balanced_parts(std::size_t n, std::size_t parts, Cost cost) -> std::vector<std::size_t> {
+			auto prefix = std::vector<std::size_t>(n + 1);
+			for (auto v = std::size_t{0}; v < n; ++v) {
+				prefix[v + 1] = prefix[v] + 1 + cost(v);
+			}
+			auto bounds = std::vector<std::size_t>{0};
+			for (auto p = std::size_t{1}; p < parts; ++p) {
+				auto const target = prefix[n] / parts * p;
+				auto const it = std::lower_bound(prefix.begin() + static_cast<std::ptrdiff_t>(bounds.back()),
+				                                 prefix.end(),
+				                                 target);
+				bounds.push_back(std::min(static_cast<std::size_t>(it - prefix.begin()), n));
+			}
+			bounds.push_back(n);
+			return bounds;
+		}
+
+		// Pull based power iteration: each node sums the shares of its in-neighbours from
+		// the transposed csr arrays, so every rank is written by one thread only. Rank of
+		// nodes without out edges is spread over all nodes.
+		template<typename Real, typename N, typename E>
+		auto pagerank(csr_graph<N, E> const& g, Real damping, Real tolerance, unsigned threads, std::size_t max_iterations)
+		    -> std::vector<Real> {
+			// below this many edges an iteration is not worth the threads
+			constexpr auto parallel_edges = std::size_t{1} << 15;
+
+			auto const n = g.node_count();
+			if (n == 0) {
+				return {};
+			}
+			auto const workers = g.edge_count() < parallel_edges ? std::size_t{1} : std::size_t{std::max(threads, 1u)};
+			auto const by_in_edges = balanced_parts(n, workers, [&](std::size_t v) {
+				return g.in_sources(static_cast<node_id>(v)).size();
+			});
+			auto const by_out_edges = balanced_parts(n, workers, [&](std::size_t v) {
+				return g.out_targets(static_cast<node_id>(v)).size();
+			});
+			auto const size = static_cast<Real>(n);
+			auto rank = std::vector<Real>(n, Real{1} / size);
+			auto next = std::vector<Real>(n);
+			// rank[u] / out degree, what u passes along each of its edges
+			auto share = std::vector<Real>(n);
+			auto dangling = std::vector<double>(workers);
+			auto change = std::vector<double>(workers);
+			auto const parts = static_cast<unsigned>(workers);
+			auto pool = worker_pool(parts);
+
+			for (auto iteration = std::size_t{0}; iteration < max_iterations; ++iteration) {
+				pool.parallel_for(workers, parts, [&](std::size_t, std::size_t, std::size_t w) {
+					auto lost = 0.0;
+					for (auto u = by_out_edges[w]; u < by_out_edges[w + 1]; ++u) {
+						auto const degree = g.out_targets(static_cast<node_id>(u)).size();
+						share[u] = degree == 0 ? Real{0} : rank[u] / static_cast<Real>(degree);
+						lost += degree == 0 ? static_cast<double>(rank[u]) : 0.0;
+					}
+					dangling[w] = lost;
+				});
+				auto const lost = std::accumulate(dangling.begin(), dangling.end(), 0.0);
+				auto const base = (Real{1} - damping) / size + damping * static_cast<Real>(lost) / size;
+				pool.parallel_for(workers, parts, [&](std::size_t, std::size_t, std::size_t w) {
+					auto moved = 0.0;
+					for (auto v = by_in_edges[w]; v < by_in_edges[w + 1]; ++v) {
+						auto sum = Real{0};
+						for (auto const u : g.in_sources(static_cast<node_id>(v))) {
+							sum += share[u];
+						}
+						next[v] = base + damping * sum;
+						moved += std::abs(static_cast<double>(next[v] - rank[v]));
+					}
+					change[w] = moved;
+				});
+				rank.swap(next);
+				if (std::accumulate(change.begin(), change.end(), 0.0) < static_cast<double>(tolerance)) {
+					break;
+				}
+			}
+			return rank;
+		}
+
+		// disjoint sets over node ids, union by size with path halving
+		class union_find {
+		 public:
+			explicit union_find(std::size_t n)
+			: parent_(n)
+			, size_(n, 1) {
+				std::iota(parent_.begin(), parent_.end(), node_id{0});
+			}
+
+			auto find(node_id x) -> node_id {
+				while (parent_[x] != x) {
+					parent_[x] = parent_[parent_[x]];
+					x = parent_[x];
+				}
+				return x;
+			}
+
+			// false when a and b were already in one set
+			auto unite(node_id a, node_id b) -> bool {
+				a = find(a);
+				b = find(b);
+				if (a == b) {
+					return false;
+				}
+				if (size_[a] < size_[b]) {
+					std::swap(a, b);
+				}
+				parent_[b] = a;
+				size_[a] += size_[b];
+				return true;
+			}
+
+		 private:
+			std::vector<node_id> parent_;
+			std::vector<std::size_t> size_;
+		};
+
+		// Lock free disjoint sets for many threads. Roots only ever link under a smaller
+		// id with a compare and swap on their own parent, so the links can't form a cycle
+		// and every root ends up the smallest id of its set. Finds halve paths as they go,
+		// a lost race there only skips a shortcut.
+		class concurrent_union_find {
+		 public:
+			explicit concurrent_union_find(std::size_t n)
+			: parent_(n) {
+				std::iota(parent_.begin(), parent_.end(), node_id{0});
+			}
+
+			auto find(node_id x) -> node_id {
+				for (;;) {
+					auto parent = std::atomic_ref(parent_[x]).load(std::memory_order_acquire);
+					auto grandparent = std::atomic_ref(parent_[parent]).load(std::memory_order_acquire);
+					if (parent == grandparent) {
+						return parent;
+					}
+					std::atomic_ref(parent_[x]).compare_exchange_weak(parent, grandparent, std::memory_order_acq_rel);
+					x = grandparent;
+				}
+			}
+
+			auto unite(node_id a, node_id b) -> void {
+				for (;;) {
+					a = find(a);
+					b = find(b);
+					if (a == b) {
+						return;
+					}
+					if (a < b) {
+						std::swap(a, b);
+					}
+					// a may have been linked since find, then retry from where it went
+					auto expected = a;
+					if (std::atomic_ref(parent_[a]).compare_exchange_strong(expected, b, std::memory_order_acq_rel)) {
+						return;
+					}
+				}
+			}
+
+		 private:
+			std::vector<node_id> parent_;
+		};
+
+		// an edge of the graph seen as undirected, with what it costs under the policy
+		template<typename E>
+		struct undirected_edge {
+			node_id src;
+			node_id dst;
+			E cost;
+			std::optional<E> weight;
+		};
+
+		// the cheapest edge of every src -> dst run, self loops left out
+		template<typename N, typename E>
+		auto spanning_candidates(csr_graph<N, E> const& g, unweighted_policy policy) -> std::vector<undirected_edge<E>> {
+			auto edges = std::vector<undirected_edge<E>>();
+			for (auto u = node_id{0}; u < g.node_count(); ++u) {
+				auto const targets = g.out_targets(u);
+				auto const weights = g.out_weights(u);
+				for (auto i = std::size_t{0}; i < targets.size(); ++i) {
+					auto const cost = edge_cost(weights[i], policy);
+					if (!cost || targets[i] == u) {
+						continue;
+					}
+					if (!edges.empty() && edges.back().src == u && edges.back().dst == targets[i]) {
+						auto& last = edges.back();
+						if (*cost < last.cost) {
+							last.cost = *cost;
+							last.weight = weights[i];
+						}
+						continue;
+					}
+					edges.push_back(undirected_edge<E>{u, targets[i], *cost, weights[i]});
+				}
+			}
+			return edges;
+		}
+
+		// the forest as a graph over every node of g, edges keep their original direction
+		template<typename N, typename E>
+		auto forest_graph(csr_graph<N, E> const& g, std::vector<undirected_edge<E>> const& edges) -> graph<N, E> {
+			auto const nodes = g.nodes();
+			auto forest = graph<N, E>(nodes.begin(), nodes.end());
+			auto links = std::vector<std::tuple<N, N, std::optional<E>>>();
+			links.reserve(edges.size());
+			for (auto const& e : edges) {
+				links.emplace_back(g.node_at(e.src), g.node_at(e.dst), e.weight);
+			}
+			forest.insert_edges(links);
+			return forest;
+		}
+	} // namespace detail
+
+	///////////////////////////////////////////
+	//******    Shortest Path Tree    *******//
+	///////////////////////////////////////////
+
+	// distances and predecessors from one source, as returned by shortest_paths
+	template<typename N, typename E>
+	class shortest_path_tree {
+	 public:
+		shortest_path_tree(csr_graph<N, E> const& g, node_id source, detail::search_state<E> state)
+		: nodes_(g.nodes())
+		, source_(source)
+		, distance_(std::move(state.distance))
+		, parent_(std::move(state.parent)) {}
+
+		[[nodiscard]] auto source() const -> N const& {
+			return nodes_[source_];
+		}
+
+		[[nodiscard]] auto reached(N const& node) const -> bool {
+			return distance(node).has_value();
+		}
+
+		// total weight of the shortest path to node, nullopt when it can't be reached
+		[[nodiscard]] auto distance(N const& node) const -> std::optional<E> {
+			return distance_[id_of(node, "distance")];
+		}
+
+		// node before node on its shortest path, nullopt for the source and unreached nodes
+		[[nodiscard]] auto parent(N const& node) const -> std::optional<N> {
+			auto const p = parent_[id_of(node, "parent")];
+			return p == detail::no_parent ? std::nullopt : std::optional<N>(nodes_[p]);
+		}
+
+		// nodes from the source to node, empty when node can't be reached
+		[[nodiscard]] auto path_to(N const& node) const -> std::vector<N> {
+			auto const id = id_of(node, "path_to");
+			if (!distance_[id]) {
+				return {};
+			}
+			return detail::unwind<N>(parent_, id, [this](node_id n) { return nodes_[n]; });
+		}
+
+		// dense results, position is the csr_graph node id
+		[[nodiscard]] auto distances() const -> std::span<std::optional<E> const> {
+			return distance_;
+		}
+
+		[[nodiscard]] auto parents() const -> std::span<node_id const> {
+			return parent_;
+		}
+
+	 private:
+		std::vector<N> nodes_;
+		node_id source_;
+		std::vector<std::optional<E>> distance_;
+		std::vector<node_id> parent_;
+
+		auto id_of(N const& node, char const* fn) const -> node_id {
+			auto const it = std::lower_bound(nodes_.begin(), nodes_.end(), node);
+			if (it == nodes_.end() || *it != node) {
+				throw std::runtime_error(std::string("Cannot call gdwg::shortest_path_tree<N, E>::") + fn
+				                         + " if node doesn't exist in the graph");
+			}
+			return static_cast<node_id>(it - nodes_.begin());
+		}
+	};
+
+	///////////////////////////////////////////
+	//********    Shortest Paths    *********//
+	///////////////////////////////////////////
+
+	// single source Dijkstra, weights must not be negative. Parallel edges relax once,
+	// with their minimum weight.
+	template<typename N, typename E>
+	auto shortest_paths(csr_graph<N, E> const& g, N const& source, unweighted_policy policy = unweighted_policy::unit)
+	    -> shortest_path_tree<N, E> {
+		auto const s = g.index_of(source);
+		if (!s) {
+			throw std::runtime_error("Cannot call gdwg::shortest_paths if source doesn't exist in the graph");
+		}
+		return shortest_path_tree<N, E>(g, *s, detail::dijkstra(g, *s, std::nullopt, policy));
+	}
+
+	template<typename N, typename E, typename Index>
+	auto shortest_paths(graph<N, E, Index> const& g, N const& source, unweighted_policy policy = unweighted_policy::unit)
+	    -> shortest_path_tree<N, E> {
+		return shortest_paths(g.freeze(), source, policy);
+	}
+
+	// point to point Dijkstra, stops once dst is settled. nullopt when dst can't be reached.
+	template<typename N, typename E>
+	auto shortest_path(csr_graph<N, E> const& g,
+	                   N const& src,
+	                   N const& dst,
+	                   unweighted_policy policy = unweighted_policy::unit) -> std::optional<weighted_path<N, E>> {
+		auto const s = g.index_of(src);
+		auto const d = g.index_of(dst);
+		if (!s || !d) {
+			throw std::runtime_error("Cannot call gdwg::shortest_path if src or dst node don't exist in the graph");
+		}
+		auto const state = detail::dijkstra(g, *s, d, policy);
+		if (!state.distance[*d]) {
+			return std::nullopt;
+		}
+		auto nodes = detail::unwind<N>(state.parent, *d, [&](node_id n) { return g.node_at(n); });
+		return weighted_path<N, E>{std::move(nodes), *state.distance[*d]};
+	}
+
+	template<typename N, typename E, typename Index>
+	auto shortest_path(graph<N, E, Index> const& g,
+	                   N const& src,
+	                   N const& dst,
+	                   unweighted_policy policy = unweighted_policy::unit) -> std::optional<weighted_path<N, E>> {
+		return shortest_path(g.freeze(), src, dst, policy);
+	}
+
+	// scratch space for bidirectional_shortest_path and astar_shortest_path. Keep one
+	// per thread and pass it to every query on the same csr_graph: its arrays are
+	// sized to the graph by the first query, later ones only clear the nodes the
+	// previous query reached, so a query costs what it settles rather than O(V).
+	template<typename E>
+	class search_workspace {
+	 public:
+		search_workspace() = default;
+
+	 private:
+		friend struct detail::workspace_access;
+
+		// forward from src, also the only side A* uses
+		detail::search_side<E> forward_;
+		// backward from dst over the transposed adjacency
+		detail::search_side<E> backward_;
+	};
+
+	namespace detail {
+		// the searches' way into a search_workspace, whose sides stay opaque to callers
+		struct workspace_access {
+			template<typename E>
+			static auto forward(search_workspace<E>& workspace) -> search_side<E>& {
+				return workspace.forward_;
+			}
+
+			template<typename E>
+			static auto backward(search_workspace<E>& workspace) -> search_side<E>& {
+				return workspace.backward_;
+			}
+		};
+	} // namespace detail
+
+	// point to point Dijkstra searching forward from src and backward from dst together,
+	// usually settling far fewer nodes than shortest_path
+	template<typename N, typename E>
+	auto bidirectional_shortest_path(csr_graph<N, E> const& g,
+	                                 N const& src,
+	                                 N const& dst,
+	                                 search_workspace<E>& workspace,
+	                                 unweighted_policy policy = unweighted_policy::unit)
+	    -> std::optional<weighted_path<N, E>> {
+		auto const s = g.index_of(src);
+		auto const d = g.index_of(dst);
+		if (!s || !d) {
+			throw std::runtime_error("Cannot call gdwg::bidirectional_shortest_path if src or dst node don't exist "
+			                         "in the graph");
+		}
+		return detail::bidirectional_dijkstra(g,
+		                                      *s,
+		                                      *d,
+		                                      detail::workspace_access::forward(workspace),
+		                                      detail::workspace_access::backward(workspace),
+		                                      policy);
+	}
+
+	// a one off query, allocating O(V) scratch space
+	template<typename N, typename E>
+	auto bidirectional_shortest_path(csr_graph<N, E> const& g,
+	                                 N const& src,
+	                                 N const& dst,
+	                                 unweighted_policy policy = unweighted_policy::unit)
+	    -> std::optional<weighted_path<N, E>> {
+		auto workspace = search_workspace<E>();
+		return bidirectional_shortest_path(g, src, dst, workspace, policy);
+	}
+
+	// freezes g on every call, O(V + E) before the search starts. For repeated queries
+	// freeze once and use the csr_graph overload with a search_workspace.
+	template<typename N, typename E, typename Index>
+	auto bidirectional_shortest_path(graph<N, E, Index> const& g,
+	                                 N const& src,
+	                                 N const& dst,
+	                                 unweighted_policy policy = unweighted_policy::unit)
+	    -> std::optional<weighted_path<N, E>> {
+		return bidirectional_shortest_path(g.freeze(), src, dst, policy);
+	}
+
+	// A* guided by heuristic(node), an estimate of the weight left to reach dst that
+	// must never be too high. A zero heuristic makes this plain Dijkstra.
+	template<typename N, typename E, typename Heuristic>
+	    requires std::is_invocable_r_v<E, Heuristic&, N const&>
+	auto astar_shortest_path(csr_graph<N, E> const& g,
+	                         N const& src,
+	                         N const& dst,
+	                         Heuristic heuristic,
+	                         search_workspace<E>& workspace,
+	                         unweighted_policy policy = unweighted_policy::unit) -> std::optional<weighted_path<N, E>> {
+		auto const s = g.index_of(src);
+		auto const d = g.index_of(dst);
+		if (!s || !d) {
+			throw std::runtime_error("Cannot call gdwg::astar_shortest_path if src or dst node don't exist in the "
+			                         "graph");
+		}
+		return detail::astar(g, *s, *d, heuristic, detail::workspace_access::forward(workspace), policy);
+	}
+
+	// a one off query, allocating O(V) scratch space
+	template<typename N, typename E, typename Heuristic>
+	    requires std::is_invocable_r_v<E, Heuristic&, N const&>
+	auto astar_shortest_path(csr_graph<N, E> const& g,
+	                         N const& src,
+	                         N const& dst,
+	                         Heuristic heuristic,
+	                         unweighted_policy policy = unweighted_policy::unit) -> std::optional<weighted_path<N, E>> {
+		auto workspace = search_workspace<E>();
+		return astar_shortest_path(g, src, dst, std::move(heuristic), workspace, policy);
+	}
+
+	// freezes g on every call, O(V + E) before the search starts. For repeated queries
+	// freeze once and use the csr_graph overload with a search_workspace.
+	template<typename N, typename E, typename Index, typename Heuristic>
+	    requires std::is_invocable_r_v<E, Heuristic&, N const&>
+	auto astar_shortest_path(graph<N, E, Index> const& g,
+	                         N const& src,
+	                         N const& dst,
+	                         Heuristic heuristic,
+	                         unweighted_policy policy = unweighted_policy::unit) -> std::optional<weighted_path<N, E>> {
+		return astar_shortest_path(g.freeze(), src, dst, std::move(heuristic), policy);
+	}
+
+	// parallel single source shortest paths by delta-stepping, same distances as
+	// shortest_paths. delta trades parallel work per round (large) against rounds
+	// that redo relaxations (small), the average edge weight is a good start.
+	template<typename N, typename E>
+	    requires std::is_arithmetic_v<E>
+	auto delta_stepping(csr_graph<N, E> const& g,
+	                    N const& source,
+	                    E delta,
+	                    unsigned threads = std::thread::hardware_concurrency(),
+	                    unweighted_policy policy = unweighted_policy::unit) -> shortest_path_tree<N, E> {
+		auto const s = g.index_of(source);
+		if (!s) {
+			throw std::runtime_error("Cannot call gdwg::delta_stepping if source doesn't exist in the graph");
+		}
+		if (!(E{} < delta)) {
+			throw std::runtime_error("Cannot call gdwg::delta_stepping with a delta that isn't positive");
+		}
+		return shortest_path_tree<N, E>(g, *s, detail::delta_stepping(g, *s, delta, threads, policy));
+	}
+
+	template<typename N, typename E, typename Index>
+	    requires std::is_arithmetic_v<E>
+	auto delta_stepping(graph<N, E, Index> const& g,
+	                    N const& source,
+	                    E delta,
+	                    unsigned threads = std::thread::hardware_concurrency(),
+	                    unweighted_policy policy = unweighted_policy::unit) -> shortest_path_tree<N, E> {
+		return delta_stepping(g.freeze(), source, delta, threads, policy);
+	}
+
+	///////////////////////////////////////////
+	//******    All Pairs Distances    ******//
+	///////////////////////////////////////////
+
+	// every shortest distance of a graph, as returned by all_pairs_shortest_paths
+	template<typename N, typename E>
+	class distance_matrix {
+	 public:
+		distance_matrix(std::vector<N> nodes, std::vector<E> distances)
+		: nodes_(std::move(nodes))
+		, distances_(std::move(distances)) {}
+
+		// O(1) lookup by csr_graph node id, nullopt when dst can't be reached
+		[[nodiscard]] auto distance(node_id src, node_id dst) const -> std::optional<E> {
+			auto const d = distances_[std::size_t{src} * nodes_.size() + dst];
+			if (d == detail::matrix_infinity<E>()) {
+				return std::nullopt;
+			}
+			return d;
+		}
+
+		[[nodiscard]] auto distance(N const& src, N const& dst) const -> std::optional<E> {
+			auto const s = index_of(src);
+			auto const d = index_of(dst);
+			if (!s || !d) {
+				throw std::runtime_error("Cannot call gdwg::distance_matrix<N, E>::distance if src or dst node don't "
+				                         "exist in the graph");
+			}
+			return distance(*s, *d);
+		}
+
+		[[nodiscard]] auto node_count() const -> std::size_t {
+			return nodes_.size();
+		}
+
+		[[nodiscard]] auto index_of(N const& value) const -> std::optional<node_id> {
+			auto const it = std::lower_bound(nodes_.begin(), nodes_.end(), value);
+			if (it == nodes_.end() || *it != value) {
+				return std::nullopt;
+			}
+			return static_cast<node_id>(it - nodes_.begin());
+		}
+
+	 private:
+		std::vector<N> nodes_;
+		// row-major, row src holds the distances from src
+		std::vector<E> distances_;
+	};
+
+	// all pairs shortest paths by blocked Floyd-Warshall, meant for graphs of a few
+	// thousand nodes since the matrix takes V * V entries. Negative weights are fine,
+	// a negative cycle throws. With integer weights the sum of two simple path weights
+	// must fit in E, so any shortest distance within [min() / 2, max() / 2) is exact.
+	template<typename N, typename E>
+	    requires std::is_arithmetic_v<E>
+	auto all_pairs_shortest_paths(csr_graph<N, E> const& g,
+	                              unsigned threads = std::thread::hardware_concurrency(),
+	                              unweighted_policy policy = unweighted_policy::unit) -> distance_matrix<N, E> {
+		auto const n = g.node_count();
+		auto d = std::vector<E>(n * n, detail::matrix_infinity<E>());
+		for (auto u = node_id{0}; u < n; ++u) {
+			auto* const row = d.data() + std::size_t{u} * n;
+			row[u] = E{};
+			detail::for_each_min_edge(g.out_targets(u), g.out_weights(u), policy, [&](node_id v, E const& w) {
+				row[v] = std::min(row[v], w);
+			});
+		}
+		detail::floyd_warshall(d, n, threads);
+		for (auto u = std::size_t{0}; u < n; ++u) {
+			if (d[u * n + u] < E{}) {
+				throw std::runtime_error("Cannot call gdwg::all_pairs_shortest_paths on a graph with a negative "
+				                         "cycle");
+			}
+		}
+		return distance_matrix<N, E>(g.nodes(), std::move(d));
+	}
+
+	template<typename N, typename E, typename Index>
+	    requires std::is_arithmetic_v<E>
+	auto all_pairs_shortest_paths(graph<N, E, Index> const& g,
+	                              unsigned threads = std::thread::hardware_concurrency(),
+	                              unweighted_policy policy = unweighted_policy::unit) -> distance_matrix<N, E> {
+		return all_pairs_shortest_paths(g.freeze(), threads, policy);
+	}
+
+	///////////////////////////////////////////
+	//**********    Components    ***********//
+	///////////////////////////////////////////
+
+	// a component label per node, as returned by the component algorithms
+	template<typename N>
+	class component_labels {
+	 public:
+		component_labels(std::vector<N> nodes, std::vector<std::uint32_t> labels, std::uint32_t count)
+		: nodes_(std::move(nodes))
+		, labels_(std::move(labels))
+		, count_(count) {}
+
+		// components are numbered 0 .. count() - 1
+		[[nodiscard]] auto count() const -> std::uint32_t {
+			return count_;
+		}
+
+		[[nodiscard]] auto component(N const& node) const -> std::uint32_t {
+			auto const it = std::lower_bound(nodes_.begin(), nodes_.end(), node);
+			if (it == nodes_.end() || *it != node) {
+				throw std::runtime_error("Cannot call gdwg::component_labels<N>::component if node doesn't exist in "
+				                         "the graph");
+			}
+			return labels_[static_cast<std::size_t>(it - nodes_.begin())];
+		}
+
+		[[nodiscard]] auto same_component(N const& a, N const& b) const -> bool {
+			return component(a) == component(b);
+		}
+
+		// nodes of one component, in node order
+		[[nodiscard]] auto members(std::uint32_t c) const -> std::vector<N> {
+			auto result = std::vector<N>();
+			for (auto id = std::size_t{0}; id < nodes_.size(); ++id) {
+				if (labels_[id] == c) {
+					result.push_back(nodes_[id]);
+				}
+			}
+			return result;
+		}
+
+		// node count of every component
+		[[nodiscard]] auto sizes() const -> std::vector<std::size_t> {
+			auto result = std::vector<std::size_t>(count_);
+			for (auto const c : labels_) {
+				++result[c];
+			}
+			return result;
+		}
+
+		// dense labels, position is the csr_graph node id
+		[[nodiscard]] auto labels() const -> std::span<std::uint32_t const> {
+			return labels_;
+		}
+
+	 private:
+		std::vector<N> nodes_;
+		std::vector<std::uint32_t> labels_;
+		std::uint32_t count_;
+	};
+
+	// components plus the DAG between them
+	template<typename N, typename E>
+	struct scc_result {
+		component_labels<N> components;
+		// one node per component id, and an unweighted edge a -> b when some edge leads
+		// from component a into component b. Ids follow a topological order of it.
+		graph<std::uint32_t, E> condensation;
+	};
+
+	// strongly connected components in O(V + E), without recursion
+	template<typename N, typename E>
+	auto strongly_connected_components(csr_graph<N, E> const& g) -> scc_result<N, E> {
+		auto [labels, count] = detail::tarjan(g);
+		auto condensation = graph<std::uint32_t, E>();
+		for (auto c = std::uint32_t{0}; c < count; ++c) {
+			condensation.insert_node(c);
+		}
+		auto links = std::vector<std::tuple<std::uint32_t, std::uint32_t, std::optional<E>>>();
+		for (auto u = node_id{0}; u < g.node_count(); ++u) {
+			for (auto const v : g.out_targets(u)) {
+				if (labels[u] != labels[v]) {
+					links.emplace_back(labels[u], labels[v], std::nullopt);
+				}
+			}
+		}
+		condensation.insert_edges(links);
+		return scc_result<N, E>{component_labels<N>(g.nodes(), std::move(labels), count), std::move(condensation)};
+	}
+
+	template<typename N, typename E, typename Index>
+	auto strongly_connected_components(graph<N, E, Index> const& g) -> scc_result<N, E> {
+		return strongly_connected_components(g.freeze());
+	}
+
+	// Weakly connected components, edges taken in both directions. Workers union the
+	// ends of every edge of their slice of nodes into one lock free union-find, slices
+	// balanced by edge count. Components are numbered in order of their smallest node.
+	template<typename N, typename E>
+	auto weakly_connected_components(csr_graph<N, E> const& g, unsigned threads = std::thread::hardware_concurrency())
+	    -> component_labels<N> {
+		// below this many edges it is not worth the threads
+		constexpr auto parallel_edges = std::size_t{1} << 15;
+
+		auto const n = g.node_count();
+		auto const workers = g.edge_count() < parallel_edges ? std::size_t{1} : std::size_t{std::max(threads, 1u)};
+		auto const parts = detail::balanced_parts(n, workers, [&](std::size_t v) {
+			return g.out_targets(static_cast<node_id>(v)).size();
+		});
+		auto sets = detail::concurrent_union_find(n);
+		auto pool = detail::worker_pool(static_cast<unsigned>(workers));
+		pool.parallel_for(workers, static_cast<unsigned>(workers), [&](std::size_t, std::size_t, std::size_t w) {
+			for (auto u = parts[w]; u < parts[w + 1]; ++u) {
+				for (auto const v : g.out_targets(static_cast<node_id>(u))) {
+					sets.unite(static_cast<node_id>(u), v);
+				}
+			}
+		});
+
+		auto roots = std::vector<node_id>(n);
+		pool.parallel_for(workers, static_cast<unsigned>(workers), [&](std::size_t, std::size_t, std::size_t w) {
+			for (auto v = parts[w]; v < parts[w + 1]; ++v) {
+				roots[v] = sets.find(static_cast<node_id>(v));
+			}
+		});
+		// roots are the smallest id of their set, so they come before their members
+		auto labels = std::vector<std::uint32_t>(n);
+		auto count = std::uint32_t{0};
+		for (auto v = node_id{0}; v < n; ++v) {
+			labels[v] = roots[v] == v ? count++ : labels[roots[v]];
+		}
+		return component_labels<N>(g.nodes(), std::move(labels), count);
+	}
+
+	template<typename N, typename E, typename Index>
+	auto weakly_connected_components(graph<N, E, Index> const& g, unsigned threads = std::thread::hardware_concurrency())
+	    -> component_labels<N> {
+		return weakly_connected_components(g.freeze(), threads);
+	}
+
+	///////////////////////////////////////////
+	//************    Ranking    ************//
+	///////////////////////////////////////////
+
+	// PageRank by power iteration until the scores move less than tolerance in total
+	// (L1). Every edge is a link, so parallel edges count more, and weights are ignored.
+	// Real picks float or double ranks, float halves the memory traffic.
+	template<typename Real = double, typename N, typename E>
+	    requires std::is_floating_point_v<Real>
+	auto pagerank(csr_graph<N, E> const& g,
+	              Real damping = Real(0.85),
+	              Real tolerance = Real(1e-6),
+	              unsigned threads = std::thread::hardware_concurrency(),
+	              std::size_t max_iterations = 100) -> std::map<N, Real> {
+		if (!(Real{0} <= damping && damping < Real{1})) {
+			throw std::runtime_error("Cannot call gdwg::pagerank with a damping factor outside [0, 1)");
+		}
+		if (!(Real{0} < tolerance)) {
+			throw std::runtime_error("Cannot call gdwg::pagerank with a tolerance that isn't positive");
+		}
+		auto const rank = detail::pagerank(g, damping, tolerance, threads, max_iterations);
+		auto result = std::map<N, Real>();
+		for (auto id = node_id{0}; id < g.node_count(); ++id) {
+			result.emplace_hint(result.end(), g.node_at(id), rank[id]);
+		}
+		return result;
+	}
+
+	template<typename Real = double, typename N, typename E, typename Index>
+	    requires std::is_floating_point_v<Real>
+	auto pagerank(graph<N, E, Index> const& g,
+	              Real damping = Real(0.85),
+	              Real tolerance = Real(1e-6),
+	              unsigned threads = std::thread::hardware_concurrency(),
+	              std::size_t max_iterations = 100) -> std::map<N, Real> {
+		return pagerank<Real>(g.freeze(), damping, tolerance, threads, max_iterations);
+	}
+
+	///////////////////////////////////////////
+	//*******    Spanning Forests    ********//
+	///////////////////////////////////////////
+
+	// Minimum spanning forest by Kruskal, edges taken as undirected. Of several edges
+	// joining two nodes only the cheapest is considered, ties go to the earlier edge in
+	// csr order so the forest is unique and matches parallel_minimum_spanning_forest.
+	template<typename N, typename E>
+	auto minimum_spanning_forest(csr_graph<N, E> const& g, unweighted_policy policy = unweighted_policy::unit)
+	    -> graph<N, E> {
+		auto edges = detail::spanning_candidates(g, policy);
+		std::stable_sort(edges.begin(), edges.end(), [](auto const& a, auto const& b) { return a.cost < b.cost; });
+		auto sets = detail::union_find(g.node_count());
+		std::erase_if(edges, [&](auto const& e) { return !sets.unite(e.src, e.dst); });
+		return detail::forest_graph(g, edges);
+	}
+
+	template<typename N, typename E, typename Index>
+	auto minimum_spanning_forest(graph<N, E, Index> const& g, unweighted_policy policy = unweighted_policy::unit)
+	    -> graph<N, E> {
+		return minimum_spanning_forest(g.freeze(), policy);
+	}
+
+	// Minimum spanning forest by Boruvka for large inputs. Every round each component
+	// picks its cheapest outgoing edge, workers scan slices of the edge list and lower
+	// a per-component best edge with a compare and swap. Components at least halve per
+	// round, so there are O(log V) rounds of O(E / threads) parallel work.
+	template<typename N, typename E>
+	auto parallel_minimum_spanning_forest(csr_graph<N, E> const& g,
+	                                      unsigned threads = std::thread::hardware_concurrency(),
+	                                      unweighted_policy policy = unweighted_policy::unit) -> graph<N, E> {
+		constexpr auto none = std::numeric_limits<std::size_t>::max();
+		// below this many edges a round is not worth the threads
+		constexpr auto parallel_edges = std::size_t{1} << 14;
+
+		auto edges = detail::spanning_candidates(g, policy);
+		auto const n = g.node_count();
+		// (cost, position) is a strict order, so equal costs can't make a cycle
+		auto const before = [&](std::size_t a, std::size_t b) {
+			return b == none || edges[a].cost < edges[b].cost || (!(edges[b].cost < edges[a].cost) && a < b);
+		};
+		auto sets = detail::union_find(n);
+		auto label = std::vector<node_id>(n);
+		std::iota(label.begin(), label.end(), node_id{0});
+		auto best = std::vector<std::size_t>(n, none);
+		auto live = std::vector<std::size_t>(edges.size());
+		std::iota(live.begin(), live.end(), std::size_t{0});
+		auto chosen = std::vector<bool>(edges.size());
+		auto pool = detail::worker_pool(threads);
+
+		while (!live.empty()) {
+			auto const workers = live.size() < parallel_edges ? 1u : std::max(threads, 1u);
+			pool.parallel_for(live.size(), workers, [&](std::size_t first, std::size_t last, std::size_t) {
+				auto offer = [&](node_id component, std::size_t e) {
+					auto slot = std::atomic_ref(best[component]);
+					auto current = slot.load(std::memory_order_relaxed);
+					while (before(e, current) && !slot.compare_exchange_weak(current, e, std::memory_order_relaxed)) {
+					}
+				};
+				for (auto i = first; i < last; ++i) {
+					auto const e = live[i];
+					offer(label[edges[e].src], e);
+					offer(label[edges[e].dst], e);
+				}
+			});
+			// join along every component's pick, two components may pick the same edge
+			for (auto c = node_id{0}; c < n; ++c) {
+				if (best[c] != none) {
+					auto const e = best[c];
+					if (sets.unite(edges[e].src, edges[e].dst)) {
+						chosen[e] = true;
+					}
+					best[c] = none;
+				}
+			}
+			for (auto v = node_id{0}; v < n; ++v) {
+				label[v] = sets.find(v);
+			}
+			std::erase_if(live, [&](std::size_t e) { return label[edges[e].src] == label[edges[e].dst]; });
+		}
+
+		auto forest = std::vector<detail::undirected_edge<E>>();
+		for (auto e = std::size_t{0}; e < edges.size(); ++e) {
+			if (chosen[e]) {
+				forest.push_back(edges[e]);
+			}
+		}
+		return detail::forest_graph(g, forest);
+	}
+
+	template<typename N, typename E, typename Index>
+	auto parallel_minimum_spanning_forest(graph<N, E, Index> const& g,
+	                                      unsigned threads = std::thread::hardware_concurrency(),
+	                                      unweighted_policy policy = unweighted_policy::unit) -> graph<N, E> {
+		return parallel_minimum_spanning_forest(g.freeze(), threads, policy);
+	}
+
+	///////////////////////////////////////////
+	//******    Breadth First Search   ******//
+	///////////////////////////////////////////
+
+	// hop levels and visit order of a breadth first search, as returned by bfs
+	template<typename N>
+	class bfs_result {
+	 public:
+		// level of a node no seed can reach
+		static constexpr std::uint32_t unreached = detail::unreached;
+
+		bfs_result(std::vector<N> nodes, std::vector<std::uint32_t> levels, std::vector<node_id> order)
+		: nodes_(std::move(nodes))
+		, levels_(std::move(levels))
+		, order_(std::move(order)) {}
+
+		[[nodiscard]] auto reached(N const& node) const -> bool {
+			return level(node).has_value();
+		}
+
+		// hops from the nearest seed, nullopt when node can't be reached
+		[[nodiscard]] auto level(N const& node) const -> std::optional<std::uint32_t> {
+			auto const it = std::lower_bound(nodes_.begin(), nodes_.end(), node);
+			if (it == nodes_.end() || *it != node) {
+				throw std::runtime_error("Cannot call gdwg::bfs_result<N>::level if node doesn't exist in the graph");
+			}
+			auto const l = levels_[static_cast<std::size_t>(it - nodes_.begin())];
+			return l == unreached ? std::nullopt : std::optional(l);
+		}
+
+		// reached nodes level by level, in node order within a level
+		[[nodiscard]] auto visited() const {
+			return std::span<node_id const>(order_)
+			       | std::views::transform([this](node_id id) -> N const& { return nodes_[id]; });
+		}
+
+		[[nodiscard]] auto visited_count() const -> std::size_t {
+			return order_.size();
+		}
+
+		// dense results, position is the csr_graph node id
+		[[nodiscard]] auto levels() const -> std::span<std::uint32_t const> {
+			return levels_;
+		}
+
+		[[nodiscard]] auto order() const -> std::span<node_id const> {
+			return order_;
+		}
+
+	 private:
+		std::vector<N> nodes_;
+		std::vector<std::uint32_t> levels_;
+		std::vector<node_id> order_;
+	};
+
+	// multi source BFS along out edges, threads workers expand each large level
+	template<typename N, typename E>
+	auto bfs(csr_graph<N, E> const& g,
+	         std::type_identity_t<std::span<N const>> seeds,
+	         unsigned threads = std::thread::hardware_concurrency()) -> bfs_result<N> {
+		auto ids = std::vector<node_id>();
+		ids.reserve(seeds.size());
+		for (auto const& seed : seeds) {
+			auto const id = g.index_of(seed);
+			if (!id) {
+				throw std::runtime_error("Cannot call gdwg::bfs if a seed node doesn't exist in the graph");
+			}
+			ids.push_back(*id);
+		}
+		auto [levels, order] = detail::bfs(g, ids, threads);
+		return bfs_result<N>(g.nodes(), std::move(levels), std::move(order));
+	}
+
+	template<typename N, typename E>
+	auto bfs(csr_graph<N, E> const& g, N const& seed, unsigned threads = std::thread::hardware_concurrency())
+	    -> bfs_result<N> {
+		return bfs(g, std::span<N const>(&seed, 1), threads);
+	}
+
+	template<typename N, typename E, typename Index>
+	auto bfs(graph<N, E, Index> const& g,
+	         std::type_identity_t<std::span<N const>> seeds,
+	         unsigned threads = std::thread::hardware_concurrency()) -> bfs_result<N> {
+		return bfs(g.freeze(), seeds, threads);
+	}
+
+	template<typename N, typename E, typename Index>
+	auto bfs(graph<N, E, Index> const& g, N const& seed, unsigned threads = std::thread::hardware_concurrency())
+	    -> bfs_result<N> {
+		return bfs(g.freeze(), seed, threads);
+	}
+} // namespace gdwg
+
+#endif // GDWG_ALGORITHM_H
@@ -0,0 +1,666 @@
+#include "gdwg_algorithm.h"
+
+#include <catch2/catch.hpp>
+
+#include <queue>
+#include <random>
+
+using namespace gdwg;
+
+namespace {
+	// random weighted graph with parallel edges and some unweighted edges
+	auto random_graph(int nodes, int edges, unsigned seed) -> gdwg::graph<std::string, int> {
+		auto g = gdwg::graph<std::string, int>{};
+		for (auto i = 0; i < nodes; ++i) {
+			g.insert_node("n" + std::to_string(i));
+		}
+		auto rng = std::mt19937{seed};
+		auto pick = std::uniform_int_distribution<int>(0, nodes - 1);
+		auto weight = std::uniform_int_distribution<int>(0, 20);
+		for (auto i = 0; i < edges; ++i) {
+			auto const src = "n" + std::to_string(pick(rng));
+			auto const dst = "n" + std::to_string(pick(rng));
+			if (i % 10 == 0) {
+				g.insert_edge(src, dst);
+			}
+			else {
+				g.insert_edge(src, dst, weight(rng));
+			}
+		}
+		return g;
+	}
+
+	// plain Bellman-Ford over every edge, the reference result
+	auto reference_distances(gdwg::graph<std::string, int> const& g, std::string const& source)
+	    -> std::map<std::string, int> {
+		auto dist = std::map<std::string, int>{{source, 0}};
+		for (auto round = std::size_t{0}; round < g.nodes().size(); ++round) {
+			for (auto const& [from, to, weight] : g) {
+				auto const d = dist.find(from);
+				if (d == dist.end()) {
+					continue;
+				}
+				auto const next = d->second + weight.value_or(1);
+				auto const [it, inserted] = dist.emplace(to, next);
+				if (!inserted && next < it->second) {
+					it->second = next;
+				}
+			}
+		}
+		return dist;
+	}
+
+	// weight of a path through its cheapest parallel edges
+	auto path_weight(gdwg::graph<std::string, int> const& g, std::vector<std::string> const& path) -> int {
+		auto total = 0;
+		for (auto i = std::size_t{1}; i < path.size(); ++i) {
+			auto best = std::numeric_limits<int>::max();
+			for (auto const& e : g.edges_view(path[i - 1], path[i])) {
+				best = std::min(best, e.weight.value_or(1));
+			}
+			total += best;
+		}
+		return total;
+	}
+} // namespace
+
+TEST_CASE("Test Shortest Paths: Dijkstra") {
+	auto g = gdwg::graph<std::string, int>{"a", "b", "c", "d", "e"};
+	g.insert_edge("a", "b", 7);
+	g.insert_edge("a", "b", 2);
+	g.insert_edge("a", "c", 9);
+	g.insert_edge("b", "c", 3);
+	g.insert_edge("c", "d");
+	g.insert_edge("d", "a", 1);
+
+	auto const tree = gdwg::shortest_paths(g, std::string("a"));
+	REQUIRE(tree.source() == "a");
+	REQUIRE(tree.distance("a") == 0);
+	REQUIRE(tree.distance("b") == 2);
+	REQUIRE(tree.distance("c") == 5);
+	REQUIRE(tree.distance("d") == 6);
+	REQUIRE_FALSE(tree.reached("e"));
+	REQUIRE(tree.parent("c") == "b");
+	REQUIRE(tree.parent("a") == std::nullopt);
+	REQUIRE(tree.path_to("d") == std::vector<std::string>{"a", "b", "c", "d"});
+	REQUIRE(tree.path_to("e").empty());
+	REQUIRE(tree.distances().size() == 5);
+
+	SECTION("Unweighted policy") {
+		REQUIRE_FALSE(gdwg::shortest_paths(g, std::string("a"), unweighted_policy::skip).reached("d"));
+		REQUIRE(gdwg::shortest_paths(g, std::string("a"), unweighted_policy::zero).distance("d") == 5);
+	}
+	SECTION("Point to point") {
+		auto const path = gdwg::shortest_path(g, std::string("a"), std::string("d"));
+		REQUIRE(path);
+		REQUIRE(path->nodes == std::vector<std::string>{"a", "b", "c", "d"});
+		REQUIRE(path->weight == 6);
+		REQUIRE(gdwg::shortest_path(g, std::string("a"), std::string("a"))->nodes == std::vector<std::string>{"a"});
+		REQUIRE_FALSE(gdwg::shortest_path(g, std::string("a"), std::string("e")));
+	}
+	SECTION("Error Case") {
+		REQUIRE_THROWS_AS(gdwg::shortest_paths(g, std::string("z")), std::runtime_error);
+		REQUIRE_THROWS_AS(tree.distance("z"), std::runtime_error);
+		REQUIRE_THROWS_AS(gdwg::shortest_path(g, std::string("a"), std::string("z")), std::runtime_error);
+		g.insert_edge("b", "e", -1);
+		REQUIRE_THROWS_AS(gdwg::shortest_paths(g, std::string("a")), std::runtime_error);
+	}
+}
+
+TEST_CASE("Test Shortest Paths: Matches Bellman-Ford") {
+	for (auto seed = 1u; seed <= 5u; ++seed) {
+		auto const g = random_graph(60, 300, seed);
+		auto const frozen = g.freeze();
+		auto const expected = reference_distances(g, "n0");
+		auto const tree = gdwg::shortest_paths(frozen, std::string("n0"));
+		for (auto const& node : g.nodes()) {
+			auto const it = expected.find(node);
+			REQUIRE(tree.distance(node) == (it == expected.end() ? std::nullopt : std::optional<int>(it->second)));
+			if (it != expected.end()) {
+				auto const path = gdwg::shortest_path(frozen, std::string("n0"), node);
+				REQUIRE(path->weight == it->second);
+				REQUIRE(path->nodes.front() == "n0");
+				REQUIRE(path->nodes.back() == node);
+			}
+		}
+	}
+}
+
+TEST_CASE("Test Shortest Paths: Bidirectional And A*") {
+	// 6x6 grid, moving right or down costs 1 or 3, so manhattan distance is admissible
+	auto g = gdwg::graph<std::pair<int, int>, int>{};
+	for (auto r = 0; r < 6; ++r) {
+		for (auto c = 0; c < 6; ++c) {
+			g.insert_node({r, c});
+		}
+	}
+	for (auto r = 0; r < 6; ++r) {
+		for (auto c = 0; c < 6; ++c) {
+			if (c + 1 < 6) {
+				g.insert_edge({r, c}, {r, c + 1}, (r + c) % 2 == 0 ? 1 : 3);
+			}
+			if (r + 1 < 6) {
+				g.insert_edge({r, c}, {r + 1, c}, (r * c) % 3 == 0 ? 1 : 3);
+			}
+		}
+	}
+	auto const frozen = g.freeze();
+	auto const src = std::pair{0, 0};
+	auto const dst = std::pair{5, 5};
+	auto const manhattan = [&](std::pair<int, int> const& n) {
+		return (dst.first - n.first) + (dst.second - n.second);
+	};
+
+	auto const expected = gdwg::shortest_path(frozen, src, dst);
+	REQUIRE(expected);
+	auto const bidirectional = gdwg::bidirectional_shortest_path(frozen, src, dst);
+	auto const astar = gdwg::astar_shortest_path(frozen, src, dst, manhattan);
+	REQUIRE(bidirectional->weight == expected->weight);
+	REQUIRE(astar->weight == expected->weight);
+	REQUIRE(bidirectional->nodes.front() == src);
+	REQUIRE(bidirectional->nodes.back() == dst);
+	REQUIRE(astar->nodes.size() == 11);
+
+	REQUIRE(gdwg::bidirectional_shortest_path(g, src, src)->nodes == std::vector{src});
+	REQUIRE_FALSE(gdwg::bidirectional_shortest_path(g, dst, src));
+	REQUIRE_FALSE(gdwg::astar_shortest_path(g, dst, src, [](auto const&) { return 0; }));
+	REQUIRE_THROWS_AS(gdwg::bidirectional_shortest_path(g, src, std::pair{9, 9}), std::runtime_error);
+	REQUIRE_THROWS_AS(gdwg::astar_shortest_path(g, std::pair{9, 9}, src, manhattan), std::runtime_error);
+}
+
+TEST_CASE("Test Shortest Paths: Point To Point Searches Agree") {
+	for (auto seed = 11u; seed <= 15u; ++seed) {
+		auto const g = random_graph(80, 400, seed);
+		auto const frozen = g.freeze();
+		auto const zero = [](std::string const&) { return 0; };
+		for (auto i = 0; i < 80; i += 7) {
+			auto const dst = "n" + std::to_string(i);
+			auto const expected = gdwg::shortest_path(frozen, std::string("n1"), dst);
+			auto const bidirectional = gdwg::bidirectional_shortest_path(frozen, std::string("n1"), dst);
+			auto const astar = gdwg::astar_shortest_path(frozen, std::string("n1"), dst, zero);
+			REQUIRE(bidirectional.has_value() == expected.has_value());
+			REQUIRE(astar.has_value() == expected.has_value());
+			if (expected) {
+				REQUIRE(bidirectional->weight == expected->weight);
+				REQUIRE(path_weight(g, bidirectional->nodes) == expected->weight);
+				REQUIRE(astar->weight == expected->weight);
+				REQUIRE(path_weight(g, astar->nodes) == expected->weight);
+			}
+		}
+	}
+}
+
+TEST_CASE("Test Shortest Paths: Reused Search Workspace") {
+	// one workspace across queries, graphs and graph sizes must match fresh searches
+	auto workspace = gdwg::search_workspace<int>();
+	auto const zero = [](std::string const&) { return 0; };
+	for (auto seed = 21u; seed <= 24u; ++seed) {
+		auto const nodes = seed % 2 == 0 ? 60 : 90;
+		auto const frozen = random_graph(nodes, nodes * 5, seed).freeze();
+		for (auto i = 0; i < nodes; i += 5) {
+			auto const src = "n" + std::to_string(i);
+			auto const dst = "n" + std::to_string((i * 7 + 3) % nodes);
+			auto const expected = gdwg::bidirectional_shortest_path(frozen, src, dst);
+			auto const bidirectional = gdwg::bidirectional_shortest_path(frozen, src, dst, workspace);
+			auto const astar = gdwg::astar_shortest_path(frozen, src, dst, zero, workspace);
+			REQUIRE(bidirectional.has_value() == expected.has_value());
+			REQUIRE(astar.has_value() == expected.has_value());
+			if (expected) {
+				REQUIRE(bidirectional->nodes == expected->nodes);
+				REQUIRE(bidirectional->weight == expected->weight);
+				REQUIRE(astar->weight == expected->weight);
+			}
+		}
+	}
+}
+
+TEST_CASE("Test Breadth First Search") {
+	auto g = gdwg::graph<std::string, int>{"a", "b", "c", "d", "e", "f"};
+	g.insert_edge("a", "b", 1);
+	g.insert_edge("a", "c");
+	g.insert_edge("c", "d", 4);
+	g.insert_edge("b", "d", 2);
+	g.insert_edge("e", "a", 1);
+
+	auto const result = gdwg::bfs(g, std::string("a"));
+	REQUIRE(result.level("a") == 0u);
+	REQUIRE(result.level("d") == 2u);
+	REQUIRE_FALSE(result.reached("e"));
+	REQUIRE(result.visited_count() == 4);
+	auto const order = std::vector<std::string>(result.visited().begin(), result.visited().end());
+	REQUIRE(order == std::vector<std::string>{"a", "b", "c", "d"});
+
+	auto const seeds = std::vector<std::string>{"f", "e"};
+	auto const many = gdwg::bfs(g, seeds);
+	REQUIRE(many.level("f") == 0u);
+	REQUIRE(many.level("a") == 1u);
+	REQUIRE(many.level("d") == 3u);
+	REQUIRE(many.levels()[0] == 1u);
+	REQUIRE_THROWS_AS(gdwg::bfs(g, std::string("z")), std::runtime_error);
+	REQUIRE_THROWS_AS(result.level("z"), std::runtime_error);
+}
+
+TEST_CASE("Test Breadth First Search: Parallel Matches Sequential") {
+	// large and dense enough to run levels bottom-up and on several threads
+	auto g = gdwg::graph<int, int>{};
+	auto const n = 4000;
+	for (auto i = 0; i < n; ++i) {
+		g.insert_node(i);
+	}
+	auto rng = std::mt19937{42};
+	auto pick = std::uniform_int_distribution<int>(0, n - 1);
+	auto edges = std::vector<std::tuple<int, int, int>>();
+	for (auto i = 0; i < 12 * n; ++i) {
+		edges.emplace_back(pick(rng), pick(rng), 1);
+	}
+	g.insert_edges(edges);
+	auto const frozen = g.freeze();
+
+	// plain queue BFS from two seeds
+	auto expected = std::vector<std::uint32_t>(n, gdwg::bfs_result<int>::unreached);
+	auto queue = std::queue<gdwg::node_id>();
+	for (auto const s : {7, 900}) {
+		expected[static_cast<std::size_t>(s)] = 0;
+		queue.push(static_cast<gdwg::node_id>(s));
+	}
+	while (!queue.empty()) {
+		auto const u = queue.front();
+		queue.pop();
+		for (auto const v : frozen.out_targets(u)) {
+			if (expected[v] == gdwg::bfs_result<int>::unreached) {
+				expected[v] = expected[u] + 1;
+				queue.push(v);
+			}
+		}
+	}
+
+	auto const seeds = std::vector<int>{7, 900};
+	for (auto const threads : {1u, 4u}) {
+		auto const result = gdwg::bfs(frozen, seeds, threads);
+		REQUIRE(std::equal(expected.begin(), expected.end(), result.levels().begin(), result.levels().end()));
+		auto const order = result.order();
+		REQUIRE(std::is_sorted(order.begin(), order.end(), [&](auto a, auto b) {
+			return expected[a] != expected[b] ? expected[a] < expected[b] : a < b;
+		}));
+		REQUIRE(order.size() == static_cast<std::size_t>(std::count_if(expected.begin(), expected.end(), [](auto l) {
+			        return l != gdwg::bfs_result<int>::unreached;
+		        })));
+	}
+}
+
+TEST_CASE("Test Worker Pool") {
+	auto pool = gdwg::detail::worker_pool(4);
+	auto cells = std::vector<int>(1000);
+	// many steps on the same threads, some narrower than the pool or run inline
+	for (auto step = 0; step < 200; ++step) {
+		auto const threads = static_cast<unsigned>(step % 5);
+		pool.parallel_for(cells.size(), threads, [&](std::size_t first, std::size_t last, std::size_t) {
+			for (auto i = first; i < last; ++i) {
+				++cells[i];
+			}
+		});
+	}
+	REQUIRE(std::ranges::all_of(cells, [](int c) { return c == 200; }));
+	SECTION("Error Case") {
+		auto const fail = [](std::size_t, std::size_t, std::size_t w) {
+			if (w == 2) {
+				throw std::runtime_error("worker 2");
+			}
+		};
+		REQUIRE_THROWS_WITH(pool.parallel_for(8, 4, fail), "worker 2");
+		// the pool still runs steps after one failed
+		auto count = std::atomic<std::size_t>(0);
+		pool.parallel_for(8, 4, [&](std::size_t first, std::size_t last, std::size_t) { count += last - first; });
+		REQUIRE(count == 8);
+	}
+}
+
+TEST_CASE("Test Delta Stepping: Matches Dijkstra") {
+	SECTION("Small graphs") {
+		for (auto seed = 21u; seed <= 25u; ++seed) {
+			auto const g = random_graph(70, 350, seed).freeze();
+			auto const expected = gdwg::shortest_paths(g, std::string("n3"));
+			for (auto const delta : {1, 4, 50}) {
+				auto const result = gdwg::delta_stepping(g, std::string("n3"), delta, 2);
+				REQUIRE(std::ranges::equal(result.distances(), expected.distances()));
+				for (auto const& node : g.nodes()) {
+					if (result.reached(node)) {
+						REQUIRE(result.path_to(node).front() == "n3");
+					}
+				}
+			}
+		}
+	}
+	SECTION("Large graph on several threads") {
+		// zero weights and fractions, with rounds big enough to split across threads
+		auto g = gdwg::graph<int, double>{};
+		auto const n = 6000;
+		for (auto i = 0; i < n; ++i) {
+			g.insert_node(i);
+		}
+		auto rng = std::mt19937{99};
+		auto pick = std::uniform_int_distribution<int>(0, n - 1);
+		auto weight = std::uniform_int_distribution<int>(0, 40);
+		auto edges = std::vector<std::tuple<int, int, double>>();
+		for (auto i = 0; i < 10 * n; ++i) {
+			edges.emplace_back(pick(rng), pick(rng), weight(rng) / 4.0);
+		}
+		g.insert_edges(edges);
+		auto const frozen = g.freeze();
+		auto const expected = gdwg::shortest_paths(frozen, 0);
+		for (auto const& [delta, threads] : {std::pair{2.5, 1u}, std::pair{2.5, 4u}, std::pair{10.0, 4u}}) {
+			auto const result = gdwg::delta_stepping(frozen, 0, delta, threads);
+			REQUIRE(std::ranges::equal(result.distances(), expected.distances()));
+			// every parent link is a tight edge
+			auto const parents = result.parents();
+			for (auto v = std::size_t{0}; v < parents.size(); ++v) {
+				if (parents[v] != gdwg::detail::no_parent) {
+					REQUIRE(*result.distances()[parents[v]] <= *result.distances()[v]);
+				}
+			}
+		}
+	}
+	SECTION("Error Case") {
+		auto const g = random_graph(5, 5, 1);
+		REQUIRE_THROWS_AS(gdwg::delta_stepping(g, std::string("n0"), 0), std::runtime_error);
+		REQUIRE_THROWS_AS(gdwg::delta_stepping(g, std::string("x"), 1), std::runtime_error);
+	}
+}
+
+TEST_CASE("Test All Pairs Shortest Paths") {
+	SECTION("Matches Dijkstra from every node") {
+		// more nodes than one tile, so the row, column and outer tiles all run
+		auto const g = random_graph(150, 900, 7).freeze();
+		for (auto const threads : {1u, 4u}) {
+			auto const all = gdwg::all_pairs_shortest_paths(g, threads);
+			for (auto src = gdwg::node_id{0}; src < g.node_count(); src += 13) {
+				auto const tree = gdwg::shortest_paths(g, g.node_at(src));
+				for (auto dst = gdwg::node_id{0}; dst < g.node_count(); ++dst) {
+					REQUIRE(all.distance(src, dst) == tree.distances()[dst]);
+				}
+			}
+		}
+	}
+	SECTION("Parallel edges, policies and negative weights") {
+		auto g = gdwg::graph<std::string, double>{"a", "b", "c", "d"};
+		g.insert_edge("a", "b", 4.5);
+		g.insert_edge("a", "b", 2.0);
+		g.insert_edge("b", "c", -1.5);
+		g.insert_edge("c", "d");
+		auto const all = gdwg::all_pairs_shortest_paths(g);
+		REQUIRE(all.distance("a", "b") == 2.0);
+		REQUIRE(all.distance("a", "c") == 0.5);
+		REQUIRE(all.distance("a", "d") == 1.5);
+		REQUIRE(all.distance("d", "a") == std::nullopt);
+		REQUIRE(all.distance("c", "c") == 0.0);
+		REQUIRE(gdwg::all_pairs_shortest_paths(g, 1, unweighted_policy::skip).distance("a", "d") == std::nullopt);
+		REQUIRE_THROWS_AS(all.distance("a", "z"), std::runtime_error);
+		g.insert_edge("d", "b", -0.5);
+		REQUIRE_THROWS_AS(gdwg::all_pairs_shortest_paths(g), std::runtime_error);
+	}
+	SECTION("Large integer distances stay reachable") {
+		// past a quarter of int's range, and a negative edge out of a node nothing reaches
+		auto g = gdwg::graph<std::string, int>{"a", "b", "c", "d"};
+		g.insert_edge("a", "b", 600000000);
+		g.insert_edge("b", "c", 400000000);
+		g.insert_edge("d", "a", -2000000000);
+		auto const all = gdwg::all_pairs_shortest_paths(g);
+		REQUIRE(all.distance("a", "b") == 600000000);
+		REQUIRE(all.distance("a", "c") == 1000000000);
+		REQUIRE(all.distance("d", "b") == -1400000000);
+		REQUIRE(all.distance("a", "d") == std::nullopt);
+		REQUIRE(all.distance("c", "a") == std::nullopt);
+	}
+}
+
+TEST_CASE("Test Strongly Connected Components") {
+	SECTION("Components and condensation") {
+		auto g = gdwg::graph<std::string, int>{"a", "b", "c", "d", "e", "f"};
+		g.insert_edge("a", "b", 1);
+		g.insert_edge("b", "c", 1);
+		g.insert_edge("c", "a");
+		g.insert_edge("c", "d", 2);
+		g.insert_edge("d", "e", 1);
+		g.insert_edge("e", "d", 1);
+		g.insert_edge("e", "d", 5);
+		g.insert_edge("f", "f", 1);
+
+		auto const result = gdwg::strongly_connected_components(g);
+		auto const& components = result.components;
+		REQUIRE(components.count() == 3);
+		REQUIRE(components.same_component("a", "c"));
+		REQUIRE(components.same_component("d", "e"));
+		REQUIRE_FALSE(components.same_component("c", "d"));
+		REQUIRE(components.members(components.component("d")) == std::vector<std::string>{"d", "e"});
+		auto sizes = components.sizes();
+		std::sort(sizes.begin(), sizes.end());
+		REQUIRE(sizes == std::vector<std::size_t>{1, 2, 3});
+
+		auto const& dag = result.condensation;
+		REQUIRE(dag.nodes() == std::vector<std::uint32_t>{0, 1, 2});
+		REQUIRE(dag.is_connected(components.component("a"), components.component("d")));
+		REQUIRE(std::distance(dag.begin(), dag.end()) == 1);
+		REQUIRE_THROWS_AS(components.component("z"), std::runtime_error);
+	}
+	SECTION("Deep cycle does not recurse") {
+		auto g = gdwg::graph<int, int>{};
+		auto const n = 200000;
+		auto edges = std::vector<std::tuple<int, int, int>>();
+		for (auto i = 0; i < n; ++i) {
+			g.insert_node(i);
+			edges.emplace_back(i, (i + 1) % n, 1);
+		}
+		// a tail hanging off the cycle is its own chain of components
+		for (auto i = n; i < n + 1000; ++i) {
+			g.insert_node(i);
+			edges.emplace_back(i - 1 == n - 1 ? 0 : i - 1, i, 1);
+		}
+		g.insert_edges(edges);
+		auto const result = gdwg::strongly_connected_components(g);
+		REQUIRE(result.components.count() == 1001);
+		REQUIRE(result.components.component(0) == 0);
+		REQUIRE(result.components.component(n + 999) == 1000);
+		for (auto const& [from, to, weight] : result.condensation) {
+			REQUIRE(from < to);
+		}
+	}
+	SECTION("Matches mutual reachability") {
+		auto const g = random_graph(40, 70, 5).freeze();
+		auto const result = gdwg::strongly_connected_components(g);
+		auto reach = std::vector<gdwg::bfs_result<std::string>>();
+		for (auto const& node : g.nodes()) {
+			reach.push_back(gdwg::bfs(g, node, 1));
+		}
+		for (auto a = gdwg::node_id{0}; a < g.node_count(); ++a) {
+			for (auto b = gdwg::node_id{0}; b < g.node_count(); ++b) {
+				auto const mutual = reach[a].reached(g.node_at(b)) && reach[b].reached(g.node_at(a));
+				REQUIRE(mutual == (result.components.labels()[a] == result.components.labels()[b]));
+			}
+		}
+	}
+}
+
+TEST_CASE("Test Weakly Connected Components") {
+	SECTION("Small graph") {
+		auto g = gdwg::graph<std::string, int>{"a", "b", "c", "d", "e", "f"};
+		g.insert_edge("b", "a", 1);
+		g.insert_edge("c", "a");
+		g.insert_edge("e", "d", 2);
+		g.insert_edge("f", "f", 1);
+
+		auto const components = gdwg::weakly_connected_components(g);
+		REQUIRE(components.count() == 3);
+		REQUIRE(components.members(0) == std::vector<std::string>{"a", "b", "c"});
+		REQUIRE(components.members(1) == std::vector<std::string>{"d", "e"});
+		REQUIRE(components.component("f") == 2);
+		REQUIRE(components.sizes() == std::vector<std::size_t>{3, 2, 1});
+		REQUIRE(gdwg::weakly_connected_components(gdwg::graph<std::string, int>{}).count() == 0);
+	}
+	SECTION("Threads match a search over both directions") {
+		// sparse enough to leave many components, big enough for the parallel path
+		auto const g = random_graph(30000, 40000, 29).freeze();
+		auto const one = gdwg::weakly_connected_components(g, 1);
+		auto const eight = gdwg::weakly_connected_components(g, 8);
+		REQUIRE(std::ranges::equal(one.labels(), eight.labels()));
+
+		auto reference = std::vector<std::uint32_t>(g.node_count(), std::numeric_limits<std::uint32_t>::max());
+		auto count = std::uint32_t{0};
+		for (auto start = gdwg::node_id{0}; start < g.node_count(); ++start) {
+			if (reference[start] != std::numeric_limits<std::uint32_t>::max()) {
+				continue;
+			}
+			auto queue = std::queue<gdwg::node_id>({start});
+			reference[start] = count;
+			while (!queue.empty()) {
+				auto const u = queue.front();
+				queue.pop();
+				for (auto const& side : {g.out_targets(u), g.in_sources(u)}) {
+					for (auto const v : side) {
+						if (reference[v] == std::numeric_limits<std::uint32_t>::max()) {
+							reference[v] = count;
+							queue.push(v);
+						}
+					}
+				}
+			}
+			++count;
+		}
+		REQUIRE(eight.count() == count);
+		REQUIRE(std::ranges::equal(eight.labels(), reference));
+	}
+}
+
+TEST_CASE("Test PageRank") {
+	SECTION("Small graph") {
+		// c is linked from everyone, d links nowhere so its rank is spread evenly
+		auto g = gdwg::graph<std::string, int>{"a", "b", "c", "d"};
+		g.insert_edge("a", "b", 1);
+		g.insert_edge("a", "c", 1);
+		g.insert_edge("b", "c", 1);
+		g.insert_edge("c", "a", 1);
+		g.insert_edge("d", "c", 1);
+		auto const rank = gdwg::pagerank(g);
+		REQUIRE(rank.size() == 4);
+		auto total = 0.0;
+		for (auto const& [node, score] : rank) {
+			total += score;
+		}
+		REQUIRE(std::abs(total - 1.0) < 1e-9);
+		REQUIRE(rank.at("c") > rank.at("a"));
+		REQUIRE(rank.at("a") > rank.at("b"));
+		REQUIRE(std::abs(rank.at("d") - 0.15 / 4) < 1e-9);
+
+		auto const single = gdwg::pagerank<float>(g, 0.85f, 1e-5f, 1);
+		REQUIRE(std::abs(single.at("c") - static_cast<float>(rank.at("c"))) < 1e-4f);
+		REQUIRE(gdwg::pagerank(gdwg::graph<std::string, int>{}).empty());
+		REQUIRE_THROWS_AS(gdwg::pagerank(g, 1.0), std::runtime_error);
+		REQUIRE_THROWS_AS(gdwg::pagerank(g, 0.85, 0.0), std::runtime_error);
+	}
+	SECTION("Threads give the same ranks") {
+		// enough edges for the parallel path, with a skewed in-degree to balance
+		auto g = gdwg::graph<int, int>{};
+		auto const n = 3000;
+		for (auto i = 0; i < n; ++i) {
+			g.insert_node(i);
+		}
+		auto rng = std::mt19937{8};
+		auto pick = std::uniform_int_distribution<int>(0, n - 1);
+		auto hub = std::uniform_int_distribution<int>(0, 20);
+		auto edges = std::vector<std::tuple<int, int, int>>();
+		for (auto i = 0; i < 20 * n; ++i) {
+			edges.emplace_back(pick(rng), hub(rng) == 0 ? 0 : pick(rng), 1);
+		}
+		g.insert_edges(edges);
+		auto const frozen = g.freeze();
+		auto const one = gdwg::pagerank(frozen, 0.85, 1e-10, 1);
+		auto const four = gdwg::pagerank(frozen, 0.85, 1e-10, 4);
+		auto const top = std::max_element(four.begin(), four.end(), [](auto const& a, auto const& b) {
+			return a.second < b.second;
+		});
+		REQUIRE(top->first == 0);
+		for (auto const& [node, score] : one) {
+			REQUIRE(std::abs(score - four.at(node)) < 1e-12);
+		}
+	}
+}
+
+TEST_CASE("Test Minimum Spanning Forest") {
+	SECTION("Small graph") {
+		// a-b-c is a triangle with a cheap parallel edge, d-e is its own tree, f is alone
+		auto g = gdwg::graph<std::string, int>{"a", "b", "c", "d", "e", "f"};
+		g.insert_edge("a", "b", 4);
+		g.insert_edge("b", "a", 1);
+		g.insert_edge("b", "c", 2);
+		g.insert_edge("c", "a", 3);
+		g.insert_edge("d", "e");
+		g.insert_edge("e", "d", 5);
+		g.insert_edge("f", "f", 0);
+
+		auto expected = gdwg::graph<std::string, int>{"a", "b", "c", "d", "e", "f"};
+		expected.insert_edge("b", "a", 1);
+		expected.insert_edge("b", "c", 2);
+		expected.insert_edge("d", "e");
+		REQUIRE(gdwg::minimum_spanning_forest(g) == expected);
+		REQUIRE(gdwg::parallel_minimum_spanning_forest(g, 2) == expected);
+
+		// skipping unweighted edges takes the other direction instead
+		expected.erase_edge("d", "e");
+		expected.insert_edge("e", "d", 5);
+		REQUIRE(gdwg::minimum_spanning_forest(g, gdwg::unweighted_policy::skip) == expected);
+		REQUIRE(gdwg::minimum_spanning_forest(gdwg::graph<std::string, int>{}).empty());
+	}
+	SECTION("Kruskal and Boruvka agree with Prim") {
+		auto const g = random_graph(300, 3000, 19);
+		auto const frozen = g.freeze();
+		auto const kruskal = gdwg::minimum_spanning_forest(frozen);
+		REQUIRE(gdwg::parallel_minimum_spanning_forest(frozen, 1) == kruskal);
+		REQUIRE(gdwg::parallel_minimum_spanning_forest(frozen, 4) == kruskal);
+
+		// dense O(V^2) Prim over the cheapest undirected edge between each pair
+		auto const nodes = g.nodes();
+		auto const n = nodes.size();
+		auto const none = std::numeric_limits<int>::max();
+		auto cost = std::vector<std::vector<int>>(n, std::vector<int>(n, none));
+		auto index = std::map<std::string, std::size_t>();
+		for (auto i = std::size_t{0}; i < n; ++i) {
+			index[nodes[i]] = i;
+		}
+		for (auto const& [from, to, weight] : g) {
+			auto const a = index[from];
+			auto const b = index[to];
+			cost[a][b] = cost[b][a] = std::min(cost[a][b], weight.value_or(1));
+		}
+		auto in_tree = std::vector<bool>(n);
+		auto best = std::vector<int>(n, none);
+		auto prim = 0;
+		for (auto round = std::size_t{0}; round < n; ++round) {
+			auto next = n;
+			for (auto v = std::size_t{0}; v < n; ++v) {
+				if (!in_tree[v] && (next == n || best[v] < best[next])) {
+					next = v;
+				}
+			}
+			in_tree[next] = true;
+			prim += best[next] == none ? 0 : best[next];
+			for (auto v = std::size_t{0}; v < n; ++v) {
+				best[v] = std::min(best[v], cost[next][v]);
+			}
+		}
+
+		auto total = 0;
+		auto edges = 0;
+		for (auto const& [from, to, weight] : kruskal) {
+			REQUIRE(weight.value_or(1) == cost[index[from]][index[to]]);
+			total += weight.value_or(1);
+			++edges;
+		}
+		REQUIRE(total == prim);
+		REQUIRE(kruskal.nodes() == nodes);
+		REQUIRE(edges < static_cast<int>(n));
+	}
+	SECTION("Large sparse graph takes the parallel rounds") {
+		auto const g = random_graph(20000, 60000, 23);
+		auto const frozen = g.freeze();
+		REQUIRE(gdwg::parallel_minimum_spanning_forest(frozen, 4) == gdwg::minimum_spanning_forest(frozen));
+	}
+}
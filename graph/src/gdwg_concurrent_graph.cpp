@@ -0,0 +1,3 @@
+#include "gdwg_concurrent_graph.h"
+
+using namespace gdwg;
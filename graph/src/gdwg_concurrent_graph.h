@@ -0,0 +1,300 @@
+#ifndef GDWG_CONCURRENT_GRAPH_H
+#define GDWG_CONCURRENT_GRAPH_H
+
+#include "gdwg_graph.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <ranges>
+#include <set>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Graphs shared between threads. A gdwg::graph itself is safe to read from many
+// threads at once, but not while any thread writes to it.
+
+namespace gdwg {
+	///////////////////////////////////////////
+	//*******    Concurrent Graph    ********//
+	///////////////////////////////////////////
+
+	// Many readers and a writer, RCU style. Readers load the published graph and query
+	// it without taking a lock, so a write never stalls them. A write copies the
+	// published graph, O(1) since copies share storage, changes the copy and publishes
+	// it. Changing the copy duplicates the adjacency lists and node values it touches,
+	// the storage leaves holding them and the O(log V) index and branch nodes above,
+	// a few microseconds per edge or node even at millions of nodes. Readers keep the
+	// old version until they drop it. Writes are serialised among themselves, update
+	// and insert_edges publish many changes for the cost of one.
+	template<typename N, typename E, typename Index = ordered_index>
+	class concurrent_graph {
+	 public:
+		using snapshot_type = std::shared_ptr<graph<N, E, Index> const>;
+
+		concurrent_graph()
+		: concurrent_graph(graph<N, E, Index>()) {}
+
+		explicit concurrent_graph(graph<N, E, Index> g)
+		: published_(std::make_shared<graph<N, E, Index> const>(std::move(g))) {}
+
+		concurrent_graph(concurrent_graph const&) = delete;
+		auto operator=(concurrent_graph const&) -> concurrent_graph& = delete;
+
+		////////  Readers  ////////
+		// the graph as of the latest write, unchanged for as long as it is held.
+		// Hold one snapshot for queries that must agree with each other.
+		[[nodiscard]] auto snapshot() const -> snapshot_type {
+			return published_.load(std::memory_order_acquire);
+		}
+
+		[[nodiscard]] auto is_node(N const& value) const -> bool {
+			return snapshot()->is_node(value);
+		}
+
+		[[nodiscard]] auto is_connected(N const& src, N const& dst) const -> bool {
+			return snapshot()->is_connected(src, dst);
+		}
+
+		// true if the edge src -> dst with this weight exists, std::nullopt for unweighted
+		[[nodiscard]] auto contains(N const& src, N const& dst, std::optional<E> weight = std::nullopt) const
+		    -> bool {
+			auto const g = snapshot();
+			for (auto const& e : g->edges_view(src, dst)) {
+				if (e.weight == weight) {
+					return true;
+				}
+			}
+			return false;
+		}
+
+		[[nodiscard]] auto connections(N const& src) const -> std::vector<N> {
+			return snapshot()->connections(src);
+		}
+
+		[[nodiscard]] auto nodes() const -> std::vector<N> {
+			return snapshot()->nodes();
+		}
+
+		////////  Writers  ////////
+		// Run f on a copy of the graph and publish the copy as one version, readers see
+		// all of f's changes or none. If f throws nothing is published. Returns what f
+		// returns.
+		template<typename F>
+		auto update(F&& f) -> decltype(auto) {
+			auto const lock = std::lock_guard(writer_);
+			// the published graph stays referenced while the copy is written, so every
+			// storage block it shares is duplicated rather than changed under a reader
+			auto next = graph<N, E, Index>(*published_.load(std::memory_order_relaxed));
+			if constexpr (std::is_void_v<std::invoke_result_t<F&, graph<N, E, Index>&>>) {
+				f(next);
+				publish(std::move(next));
+			}
+			else {
+				auto result = f(next);
+				publish(std::move(next));
+				return result;
+			}
+		}
+
+		auto insert_node(N const& value) -> bool {
+			return update([&](auto& g) { return g.insert_node(value); });
+		}
+
+		auto insert_edge(N const& src, N const& dst, std::optional<E> weight = std::nullopt) -> bool {
+			return update([&](auto& g) { return g.insert_edge(src, dst, weight); });
+		}
+
+		// bulk load (src, dst, weight) tuples as one version, like graph::insert_edges
+		template<std::ranges::input_range R>
+		auto insert_edges(R&& edges) -> std::size_t {
+			return update([&](auto& g) { return g.insert_edges(edges); });
+		}
+
+		auto erase_node(N const& value) -> bool {
+			return update([&](auto& g) { return g.erase_node(value); });
+		}
+
+		auto erase_edge(N const& src, N const& dst, std::optional<E> weight = std::nullopt) -> bool {
+			return update([&](auto& g) { return g.erase_edge(src, dst, weight); });
+		}
+
+		auto clear() -> void {
+			update([](auto& g) { g.clear(); });
+		}
+
+	 private:
+		auto publish(graph<N, E, Index> next) -> void {
+			published_.store(std::make_shared<graph<N, E, Index> const>(std::move(next)), std::memory_order_release);
+		}
+
+		std::atomic<snapshot_type> published_;
+		std::mutex writer_;
+	};
+
+	///////////////////////////////////////////
+	//*********    Sharded Graph    *********//
+	///////////////////////////////////////////
+
+	// Many writers. Nodes are spread over shards by hash, each shard holding its nodes
+	// and their out edges under its own lock, so calls on different threads only wait
+	// for each other when they touch the same shard. A call naming src and dst locks
+	// both of their shards in shard order, erase_node and merge lock every shard.
+	template<typename N, typename E, typename Hash = std::hash<N>>
+	class sharded_graph {
+	 public:
+		explicit sharded_graph(std::size_t shards = 64)
+		: shards_(std::max(shards, std::size_t{1})) {}
+
+		sharded_graph(sharded_graph const&) = delete;
+		auto operator=(sharded_graph const&) -> sharded_graph& = delete;
+
+		[[nodiscard]] auto shard_count() const -> std::size_t {
+			return shards_.size();
+		}
+
+		auto insert_node(N const& value) -> bool {
+			auto& s = shard_of(value);
+			auto const lock = std::lock_guard(s.mutex);
+			return s.out.try_emplace(value).second;
+		}
+
+		// like gdwg::graph, throws when src or dst is not a node
+		auto insert_edge(N const& src, N const& dst, std::optional<E> weight = std::nullopt) -> bool {
+			auto const locks = lock_pair(src, dst);
+			auto const edges = find_pair(*this, src, dst);
+			if (!edges) {
+				throw std::runtime_error("Cannot call gdwg::sharded_graph<N, E>::insert_edge when either src or dst "
+				                         "node does not exist");
+			}
+			return edges->emplace(dst, weight).second;
+		}
+
+		auto erase_edge(N const& src, N const& dst, std::optional<E> weight = std::nullopt) -> bool {
+			auto const locks = lock_pair(src, dst);
+			auto const edges = find_pair(*this, src, dst);
+			if (!edges) {
+				throw std::runtime_error("Cannot call gdwg::sharded_graph<N, E>::erase_edge on src or dst if they "
+				                         "don't exist in the graph");
+			}
+			return edges->erase({dst, weight}) > 0;
+		}
+
+		// removes the node's edges in every shard, so it waits for all of them
+		auto erase_node(N const& value) -> bool {
+			auto const locks = lock_all();
+			if (shard_of(value).out.erase(value) == 0) {
+				return false;
+			}
+			for (auto& s : shards_) {
+				for (auto& [src, edges] : s.out) {
+					std::erase_if(edges, [&](auto const& e) { return e.first == value; });
+				}
+			}
+			return true;
+		}
+
+		[[nodiscard]] auto is_node(N const& value) const -> bool {
+			auto& s = shard_of(value);
+			auto const lock = std::lock_guard(s.mutex);
+			return s.out.contains(value);
+		}
+
+		[[nodiscard]] auto is_connected(N const& src, N const& dst) const -> bool {
+			auto const locks = lock_pair(src, dst);
+			auto const edges = find_pair(*this, src, dst);
+			if (!edges) {
+				throw std::runtime_error("Cannot call gdwg::sharded_graph<N, E>::is_connected if src or dst node "
+				                         "don't exist in the graph");
+			}
+			auto const it = edges->lower_bound({dst, std::nullopt});
+			return it != edges->end() && it->first == dst;
+		}
+
+		// a regular graph of everything inserted so far, taken with every shard locked
+		template<typename Index = ordered_index>
+		[[nodiscard]] auto merge() const -> graph<N, E, Index> {
+			auto const locks = lock_all();
+			auto result = graph<N, E, Index>();
+			auto edges = std::vector<std::tuple<N, N, std::optional<E>>>();
+			for (auto const& s : shards_) {
+				for (auto const& [src, out] : s.out) {
+					result.insert_node(src);
+					for (auto const& [dst, weight] : out) {
+						edges.emplace_back(src, dst, weight);
+					}
+				}
+			}
+			result.insert_edges(edges);
+			return result;
+		}
+
+	 private:
+		// edges ordered by dst, then unweighted before weighted
+		using edge_set = std::set<std::pair<N, std::optional<E>>>;
+
+		// a line of its own, so neighbouring locks don't share a cache line
+		struct alignas(64) shard {
+			mutable std::mutex mutex;
+			std::map<N, edge_set> out;
+		};
+
+		[[nodiscard]] auto shard_index(N const& value) const -> std::size_t {
+			return Hash{}(value) % shards_.size();
+		}
+
+		[[nodiscard]] auto shard_of(N const& value) const -> shard const& {
+			return shards_[shard_index(value)];
+		}
+
+		[[nodiscard]] auto shard_of(N const& value) -> shard& {
+			return shards_[shard_index(value)];
+		}
+
+		// the shards of a and b, the lower index first so two calls can't deadlock
+		[[nodiscard]] auto lock_pair(N const& a, N const& b) const
+		    -> std::pair<std::unique_lock<std::mutex>, std::unique_lock<std::mutex>> {
+			auto const i = shard_index(a);
+			auto const j = shard_index(b);
+			auto const low = std::min(i, j);
+			auto const high = std::max(i, j);
+			auto first = std::unique_lock(shards_[low].mutex);
+			if (low == high) {
+				return {std::move(first), std::unique_lock<std::mutex>()};
+			}
+			return {std::move(first), std::unique_lock(shards_[high].mutex)};
+		}
+
+		[[nodiscard]] auto lock_all() const -> std::vector<std::unique_lock<std::mutex>> {
+			auto locks = std::vector<std::unique_lock<std::mutex>>();
+			locks.reserve(shards_.size());
+			for (auto const& s : shards_) {
+				locks.emplace_back(s.mutex);
+			}
+			return locks;
+		}
+
+		// src's edges if both src and dst are nodes, else null. Their shards must be locked.
+		template<typename Self>
+		static auto find_pair(Self& self, N const& src, N const& dst) -> decltype(&self.shards_[0].out.at(src)) {
+			auto& out = self.shard_of(src).out;
+			auto const it = out.find(src);
+			if (it == out.end() || !self.shard_of(dst).out.contains(dst)) {
+				return nullptr;
+			}
+			return &it->second;
+		}
+
+		std::vector<shard> shards_;
+	};
+} // namespace gdwg
+
+#endif // GDWG_CONCURRENT_GRAPH_H
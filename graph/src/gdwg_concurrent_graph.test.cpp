@@ -0,0 +1,161 @@
+#include "gdwg_concurrent_graph.h"
+
+#include <catch2/catch.hpp>
+
+#include <thread>
+
+using namespace gdwg;
+
+TEST_CASE("Test Concurrent Graph: Writes") {
+	auto g = gdwg::concurrent_graph<std::string, int>{gdwg::graph<std::string, int>{"a", "b"}};
+	REQUIRE(g.insert_node("c"));
+	REQUIRE_FALSE(g.insert_node("c"));
+	REQUIRE(g.insert_edge("a", "b", 1));
+	REQUIRE(g.insert_edge("a", "c"));
+	REQUIRE(g.is_connected("a", "b"));
+	REQUIRE(g.contains("a", "c"));
+	REQUIRE_FALSE(g.contains("a", "c", 1));
+	REQUIRE(g.connections("a") == std::vector<std::string>{"b", "c"});
+	REQUIRE_THROWS_AS(g.insert_edge("a", "z", 1), std::runtime_error);
+
+	SECTION("Snapshots keep their version") {
+		auto const before = g.snapshot();
+		REQUIRE(g.erase_edge("a", "b", 1));
+		REQUIRE(g.erase_node("c"));
+		REQUIRE_FALSE(g.is_connected("a", "b"));
+		REQUIRE(g.nodes() == std::vector<std::string>{"a", "b"});
+		REQUIRE(before->is_connected("a", "b"));
+		REQUIRE(before->nodes() == std::vector<std::string>{"a", "b", "c"});
+	}
+	SECTION("Updates publish everything or nothing") {
+		auto const inserted = g.update([](auto& graph) {
+			graph.insert_node("d");
+			return graph.insert_edge("d", "a", 4);
+		});
+		REQUIRE(inserted);
+		REQUIRE(g.is_connected("d", "a"));
+
+		auto const before = g.snapshot();
+		REQUIRE_THROWS_AS(g.update([](auto& graph) {
+			graph.insert_node("e");
+			graph.insert_edge("e", "z", 1);
+		}),
+		                  std::runtime_error);
+		REQUIRE(g.snapshot() == before);
+		REQUIRE_FALSE(g.is_node("e"));
+
+		auto const batch =
+		    std::vector<std::tuple<std::string, std::string, int>>{{"a", "d", 1}, {"d", "b", 2}, {"a", "d", 1}};
+		REQUIRE(g.insert_edges(batch) == 2);
+		REQUIRE(g.is_connected("d", "b"));
+		REQUIRE_THROWS_AS(g.insert_edges(std::vector<std::tuple<std::string, std::string, int>>{{"a", "z", 1}}),
+		                  std::runtime_error);
+
+		g.clear();
+		REQUIRE(g.snapshot()->empty());
+	}
+}
+
+TEST_CASE("Test Concurrent Graph: Readers During Writes") {
+	// every update adds a node with edges both ways to the hub, so any snapshot a
+	// reader holds must have both edges of each node or neither
+	auto g = gdwg::concurrent_graph<std::string, int>{gdwg::graph<std::string, int>{"hub"}};
+	auto const writes = 500;
+	auto done = std::atomic<bool>(false);
+	auto torn = std::atomic<int>(0);
+
+	auto readers = std::vector<std::thread>();
+	for (auto r = 0; r < 4; ++r) {
+		readers.emplace_back([&] {
+			while (!done.load()) {
+				auto const snapshot = g.snapshot();
+				for (auto const& node : snapshot->connections("hub")) {
+					if (!snapshot->is_connected(node, "hub")) {
+						++torn;
+					}
+				}
+				if (snapshot->connections("hub").size() + 1 != snapshot->nodes().size()) {
+					++torn;
+				}
+			}
+		});
+	}
+	for (auto i = 0; i < writes; ++i) {
+		g.update([i](auto& graph) {
+			auto const node = "n" + std::to_string(i);
+			graph.insert_node(node);
+			graph.insert_edge("hub", node, i);
+			graph.insert_edge(node, "hub", i);
+		});
+		if (i % 50 == 0) {
+			REQUIRE(g.erase_node("n" + std::to_string(i / 2)));
+		}
+	}
+	done = true;
+	for (auto& t : readers) {
+		t.join();
+	}
+	REQUIRE(torn == 0);
+	REQUIRE(g.nodes().size() == writes + 1 - 10);
+}
+
+TEST_CASE("Test Sharded Graph") {
+	SECTION("Matches gdwg::graph") {
+		auto g = gdwg::sharded_graph<std::string, int>{4};
+		REQUIRE(g.shard_count() == 4);
+		for (auto const* node : {"a", "b", "c", "d"}) {
+			REQUIRE(g.insert_node(node));
+		}
+		REQUIRE_FALSE(g.insert_node("a"));
+		REQUIRE(g.insert_edge("a", "b", 2));
+		REQUIRE(g.insert_edge("a", "b"));
+		REQUIRE_FALSE(g.insert_edge("a", "b", 2));
+		REQUIRE(g.insert_edge("c", "a", 1));
+		REQUIRE(g.insert_edge("d", "d", 3));
+		REQUIRE(g.is_connected("a", "b"));
+		REQUIRE_FALSE(g.is_connected("b", "a"));
+		REQUIRE_THROWS_AS(g.insert_edge("a", "z", 1), std::runtime_error);
+		REQUIRE_THROWS_AS(g.is_connected("z", "a"), std::runtime_error);
+
+		REQUIRE(g.erase_edge("a", "b"));
+		REQUIRE_FALSE(g.erase_edge("a", "b"));
+		REQUIRE(g.erase_node("a"));
+		REQUIRE_FALSE(g.is_node("a"));
+
+		auto expected = gdwg::graph<std::string, int>{"b", "c", "d"};
+		expected.insert_edge("d", "d", 3);
+		REQUIRE(g.merge() == expected);
+	}
+	SECTION("Writers on many threads") {
+		// each writer links its own chain of nodes into a shared set of hubs
+		auto g = gdwg::sharded_graph<std::string, int>{16};
+		auto const hubs = 8;
+		auto const per_writer = 300;
+		for (auto h = 0; h < hubs; ++h) {
+			g.insert_node("hub" + std::to_string(h));
+		}
+		auto writers = std::vector<std::thread>();
+		for (auto w = 0; w < 4; ++w) {
+			writers.emplace_back([&g, w] {
+				for (auto i = 0; i < per_writer; ++i) {
+					auto const node = "w" + std::to_string(w) + "_" + std::to_string(i);
+					g.insert_node(node);
+					g.insert_edge(node, "hub" + std::to_string(i % hubs), w);
+					g.insert_edge("hub" + std::to_string(i % hubs), node, i);
+					if (i % 3 == 0) {
+						g.erase_edge(node, "hub" + std::to_string(i % hubs), w);
+					}
+				}
+			});
+		}
+		for (auto& t : writers) {
+			t.join();
+		}
+		auto const merged = g.merge();
+		REQUIRE(merged.nodes().size() == hubs + 4 * per_writer);
+		REQUIRE(std::distance(merged.begin(), merged.end()) == 4 * per_writer * 2 - 4 * per_writer / 3);
+		REQUIRE(merged.is_connected("hub1", "w2_9"));
+		REQUIRE_FALSE(merged.is_connected("w2_9", "hub1"));
+		REQUIRE(merged.is_connected("w2_10", "hub2"));
+	}
+}
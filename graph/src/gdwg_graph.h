@@ -3,19 +3,46 @@
 
 #include <initializer_list>
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <charconv>
+#include <concepts>
+#include <cstdint>
+#include <functional>
 #include <iostream>
+#include <iterator>
+#include <limits>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <numeric>
 #include <optional>
 #include <ostream>
+#include <ranges>
 #include <set>
+#include <sstream>
+#include <span>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace gdwg {
+	// dense node index used by the graph and its frozen layouts
+	using node_id = std::uint32_t;
+
 	// declaration at begin
-	template<typename N, typename E>
+	struct ordered_index;
+	template<typename N, typename E, typename Index = ordered_index>
 	class graph;
+	template<typename N, typename E>
+	class csr_graph;
+	namespace detail {
+		struct graph_builder;
+	} // namespace detail
 
 	///////////////////////////////////////////
 	//**********    Edge Class     **********//
@@ -108,565 +135,1664 @@ namespace gdwg {
 	};
 
 	///////////////////////////////////////////
-	//**********    Graph Class    **********//
+	//*********    Edge View Type    *********//
 	///////////////////////////////////////////
 
+	// non-owning view of one edge, it refers to the graph's node values and stays
+	// valid until the graph is modified
 	template<typename N, typename E>
-	class graph {
-	 public:
-		class iterator;
-		using edge = gdwg::edge<N, E>;
-
-		// Your member functions go here
-
-		////////  Constructor  ////////
-		graph() noexcept = default;
+	struct edge_view {
+		N const& from;
+		N const& to;
+		std::optional<E> weight;
+	};
 
-		// initial list
-		graph(std::initializer_list<N> il)
-		: graph(il.begin(), il.end()) {}
+	namespace detail {
+		// array of T whose copies share storage. Elements sit in leaves of 2^LeafBits
+		// under a radix tree of 64 way branches, all reference counted, so copying is
+		// O(1) and a write after a copy duplicates the one leaf it lands in and the
+		// O(log V) branches above it.
+		template<typename T, std::size_t LeafBits = 6>
+		class cow_array {
+			static_assert(LeafBits >= 6, "a leaf holds at least as much as a branch");
+
+		 public:
+			cow_array() = default;
+			cow_array(cow_array const&) = default;
+			auto operator=(cow_array const&) -> cow_array& = default;
+
+			cow_array(cow_array&& other) noexcept
+			: root_(std::move(other.root_))
+			, size_(std::exchange(other.size_, 0))
+			, height_(std::exchange(other.height_, 0)) {}
+
+			auto operator=(cow_array&& other) noexcept -> cow_array& {
+				root_ = std::move(other.root_);
+				size_ = std::exchange(other.size_, 0);
+				height_ = std::exchange(other.height_, 0);
+				return *this;
+			}
 
-		// input Iterator
-		template<typename InputIt>
-		graph(InputIt first, InputIt last) {
-			for (auto it = first; it != last; ++it) {
-				if (nodes_.find(*it) == nodes_.end()) {
-					nodes_.insert(*it);
+			// size copies of value
+			cow_array(std::size_t size, T const& value) {
+				for (auto i = std::size_t{0}; i < size; ++i) {
+					push_back(value);
 				}
 			}
-		}
-
-		// move constructor
-		graph(graph&& other) noexcept {
-			*this = std::move(other);
-		}
 
-		// move operator
-		auto operator=(graph&& other) noexcept -> graph& {
-			if (this != &other) {
-				nodes_ = std::move(other.nodes_);
-				edges_ = std::move(other.edges_);
-				connect_ = std::move(other.connect_);
-				other.clear();
+			[[nodiscard]] auto operator[](std::size_t i) const -> T const& {
+				auto const* node = root_.get();
+				for (auto shift = top_shift(); shift >= LeafBits; shift -= bits) {
+					node = static_cast<branch const*>(node)->child[(i >> shift) & mask].get();
+				}
+				return (*static_cast<leaf const*>(node))[i & leaf_mask];
 			}
-			return *this;
-		}
 
-		// copy constructor
-		graph(graph const& other) {
-			*this = other;
-		}
+			// mutable access, copying the leaf and branches still shared with another array
+			auto write(std::size_t i) -> T& {
+				auto* link = &root_;
+				for (auto shift = top_shift(); shift >= LeafBits; shift -= bits) {
+					link = &own<branch>(*link).child[(i >> shift) & mask];
+				}
+				return own<leaf>(*link)[i & leaf_mask];
+			}
 
-		// copy operator
-		auto operator=(graph const& other) -> graph& {
-			if (this != &other) {
-				for (auto& n : other.nodes_) {
-					nodes_.insert(n);
+			auto push_back(T value) -> void {
+				if (!root_) {
+					root_ = std::make_shared<leaf>();
 				}
-				// copy connect from other graph
-				for (const auto& e : other.connect_) {
-					connect_.emplace(e.first, e.second);
+				else if (size_ == leaf_size << (height_ * bits)) {
+					// full, the old root becomes the first child of a new one
+					auto up = std::make_shared<branch>();
+					up->child[0] = std::move(root_);
+					root_ = std::move(up);
+					++height_;
 				}
-				// copy edge from other graph
-				for (const auto& e : other.edges_) {
-					edges_.push_back(e);
+				auto* link = &root_;
+				for (auto shift = top_shift(); shift >= LeafBits; shift -= bits) {
+					link = &own<branch>(*link).child[(size_ >> shift) & mask];
+					if (!*link) {
+						*link = shift == LeafBits ? std::shared_ptr<void>(std::make_shared<leaf>())
+						                          : std::shared_ptr<void>(std::make_shared<branch>());
+					}
 				}
+				own<leaf>(*link)[size_ & leaf_mask] = std::move(value);
+				++size_;
 			}
-			return *this;
-		}
 
-		/////////////////////////////
-		////////  Modifiers  ////////
-		/////////////////////////////
+			auto pop_back() -> void {
+				write(size_ - 1) = T();
+				--size_;
+			}
 
-		auto insert_node(N const& value) -> bool {
-			if (nodes_.count(value) != 0) {
-				return false;
+			[[nodiscard]] auto back() const -> T const& {
+				return (*this)[size_ - 1];
 			}
-			nodes_.insert(value);
-			return true;
-		}
 
-		auto insert_edge(N const& src, N const& dst, std::optional<E> weight = std::nullopt) -> bool {
-			// check src and dst are node
-			if (!is_node(src) || !is_node(dst)) {
-				throw std::runtime_error("Cannot call gdwg::graph<N, E>::insert_edge when either src or dst node does "
-				                         "not "
-				                         "exist");
+			[[nodiscard]] auto size() const -> std::size_t {
+				return size_;
 			}
-			// check no two edge are same
-			auto& src_edges = connect_[src];
-			for (const auto& e : src_edges) {
-				if (e->get_nodes().second == dst && e->get_weight() == weight) {
-					return false;
+
+			[[nodiscard]] auto empty() const -> bool {
+				return size_ == 0;
+			}
+
+			auto clear() noexcept -> void {
+				root_.reset();
+				size_ = 0;
+				height_ = 0;
+			}
+
+		 private:
+			static constexpr std::size_t bits = 6;
+			static constexpr std::size_t fanout = std::size_t{1} << bits;
+			static constexpr std::size_t mask = fanout - 1;
+			static constexpr std::size_t leaf_size = std::size_t{1} << LeafBits;
+			static constexpr std::size_t leaf_mask = leaf_size - 1;
+			using leaf = std::array<T, leaf_size>;
+			struct branch {
+				std::array<std::shared_ptr<void>, fanout> child;
+			};
+
+			// shift of the root branch's index bits, below LeafBits when the root is a leaf
+			[[nodiscard]] auto top_shift() const -> std::size_t {
+				return LeafBits + height_ * bits - bits;
+			}
+
+			template<typename Node>
+			static auto own(std::shared_ptr<void>& p) -> Node& {
+				if (p.use_count() > 1) {
+					p = std::make_shared<Node>(*static_cast<Node const*>(p.get()));
 				}
+				return *static_cast<Node*>(p.get());
 			}
-			// add new edge
-			std::shared_ptr<edge> edge_ptr;
-			if (weight) {
-				edge_ptr = std::make_shared<weighted_edge<N, E>>(src, dst, *weight);
+
+			// a leaf at height 0, every branch level above it holds 64 times as much
+			std::shared_ptr<void> root_;
+			std::size_t size_ = 0;
+			std::size_t height_ = 0;
+		};
+
+		// cow_array of T with each element boxed, so copying a leaf copies 64 pointers
+		// rather than 64 T, and a write copies only the element it changes
+		template<typename T>
+		class cow_vector {
+		 public:
+			[[nodiscard]] auto operator[](std::size_t i) const -> T const& {
+				return *items_[i];
 			}
-			else {
-				edge_ptr = std::make_shared<unweighted_edge<N, E>>(src, dst);
+
+			// mutable access, copying whatever is still shared with another vector
+			auto write(std::size_t i) -> T& {
+				auto& box = items_.write(i);
+				if (box.use_count() > 1) {
+					box = std::make_shared<T>(*box);
+				}
+				return *box;
 			}
 
-			edges_.push_back(edge_ptr);
-			src_edges.push_back(edge_ptr);
-			sort(edges_.begin(), edges_.end(), gdwg::graph<N, E>::compareEdge);
-			sort(src_edges.begin(), src_edges.end(), gdwg::graph<N, E>::compareEdge);
-			return true;
-		}
+			auto push_back(T value) -> void {
+				items_.push_back(std::make_shared<T>(std::move(value)));
+			}
 
-		auto replace_node(N const& old_data, N const& new_data) -> bool {
-			if (!is_node(old_data)) {
-				throw std::runtime_error("Cannot call gdwg::graph<N, E>::replace_node on a node that doesn't exist");
+			[[nodiscard]] auto size() const -> std::size_t {
+				return items_.size();
 			}
-			if (nodes_.count(new_data) == 1) {
-				return false;
+
+			auto clear() noexcept -> void {
+				items_.clear();
 			}
 
-			// replace node
-			nodes_.erase(old_data);
-			nodes_.insert(new_data);
+		 private:
+			cow_array<std::shared_ptr<T>> items_;
+		};
+	} // namespace detail
 
-			// replace related edges start with src in connect
-			auto& all_edges = connect_[old_data];
-			for (auto& e : all_edges) {
-				if (e->is_weighted()) {
-					e = std::make_shared<weighted_edge<N, E>>(new_data, e->get_nodes().second, *(e->get_weight()));
-				}
-				else {
-					e = std::make_shared<unweighted_edge<N, E>>(new_data, e->get_nodes().second);
-				}
+	///////////////////////////////////////////
+	//******    Node Index Policies    ******//
+	///////////////////////////////////////////
+
+	// A node index maps a node value to its id. Keys point into the graph's value
+	// storage, which copies of a graph share, so an index is persistent as well: a copy
+	// shares its structure and a write after a copy duplicates O(log V) of it. Both
+	// policies walk the ids in sorted node order, for_each in one pass and
+	// first/next/prev/last a step at a time. sorted_lookups says whether a batch of
+	// finds is cheaper made in sorted order, stepping between neighbours.
+
+	// balanced tree, sorted order comes for free. An AVL tree whose nodes are reference
+	// counted, an insert or erase copies the shared nodes on its path (path copying).
+	// Each id also links to its neighbours in order, so stepping is O(1).
+	struct ordered_index {
+		template<typename N>
+		class type {
+		 public:
+			type() = default;
+			type(type const&) = default;
+			auto operator=(type const&) -> type& = default;
+
+			static constexpr bool sorted_lookups = true;
+
+			type(type&& other) noexcept
+			: root_(std::move(other.root_))
+			, size_(std::exchange(other.size_, 0))
+			, next_(std::move(other.next_))
+			, prev_(std::move(other.prev_)) {}
+
+			auto operator=(type&& other) noexcept -> type& {
+				root_ = std::move(other.root_);
+				size_ = std::exchange(other.size_, 0);
+				next_ = std::move(other.next_);
+				prev_ = std::move(other.prev_);
+				return *this;
 			}
-			sort(all_edges.begin(), all_edges.end(), gdwg::graph<N, E>::compareEdge);
 
-			// replace edges in edge list
-			for (auto& e : edges_) {
-				if (e->get_nodes().first == old_data) {
-					if (e->is_weighted()) {
-						e = std::make_shared<weighted_edge<N, E>>(new_data, e->get_nodes().second, *(e->get_weight()));
-					}
-					else {
-						e = std::make_shared<unweighted_edge<N, E>>(new_data, e->get_nodes().second);
-					}
-				}
-				if (e->get_nodes().second == old_data) {
-					// replace edge that at distinat
-					auto& dst_edges = connect_[e->get_nodes().first];
-					for (auto& e_dst : dst_edges) {
-						if (e_dst->get_nodes().second == old_data) {
-							if (e_dst->is_weighted()) {
-								e_dst = std::make_shared<weighted_edge<N, E>>(e->get_nodes().first,
-								                                              new_data,
-								                                              *(e_dst->get_weight()));
-							}
-							else {
-								e_dst = std::make_shared<unweighted_edge<N, E>>(e->get_nodes().first, new_data);
-							}
-						}
+			[[nodiscard]] auto find(N const& value) const -> std::optional<node_id> {
+				for (auto const* t = root_.get(); t != nullptr;) {
+					if (value < *t->key) {
+						t = t->left.get();
 					}
-					sort(dst_edges.begin(), dst_edges.end(), gdwg::graph<N, E>::compareEdge);
-					if (e->is_weighted()) {
-						e = std::make_shared<weighted_edge<N, E>>(e->get_nodes().first, new_data, *(e->get_weight()));
+					else if (*t->key < value) {
+						t = t->right.get();
 					}
 					else {
-						e = std::make_shared<unweighted_edge<N, E>>(e->get_nodes().first, new_data);
+						return t->id;
 					}
 				}
+				return std::nullopt;
 			}
-			sort(edges_.begin(), edges_.end(), gdwg::graph<N, E>::compareEdge);
-			connect_[new_data] = std::move(connect_[old_data]);
-			connect_.erase(old_data);
 
-			return true;
-		}
+			auto insert(N const& value, node_id id) -> void {
+				auto before = none;
+				auto after = none;
+				insert(root_, &value, id, before, after);
+				link(before, id);
+				link(id, after);
+				++size_;
+			}
 
-		auto merge_replace_node(N const& old_data, N const& new_data) -> void {
-			if (!is_node(old_data) || !is_node(new_data)) {
-				throw std::runtime_error("Cannot call gdwg::graph<N, E>::replace_node on a node that doesn't exist");
+			auto erase(N const& value) -> void {
+				auto const id = *find(value);
+				erase(root_, value);
+				link(prev_[id], next_[id]);
+				--size_;
 			}
-			// replace node
-			if (nodes_.count(new_data) == 1) {
-				nodes_.erase(old_data);
-				nodes_.insert(new_data);
+
+			[[nodiscard]] auto size() const -> std::size_t {
+				return size_;
 			}
 
-			// replace edges in edge list
-			for (auto& e : edges_) {
-				if (e->get_nodes().first == old_data) {
-					if (e->is_weighted()) {
-						e = std::make_shared<weighted_edge<N, E>>(new_data, e->get_nodes().second, *(e->get_weight()));
-					}
-					else {
-						e = std::make_shared<unweighted_edge<N, E>>(new_data, e->get_nodes().second);
-					}
+			[[nodiscard]] auto empty() const -> bool {
+				return size_ == 0;
+			}
+
+			auto clear() noexcept -> void {
+				root_.reset();
+				size_ = 0;
+				next_.clear();
+				prev_.clear();
+			}
+
+			[[nodiscard]] auto first() const -> std::optional<node_id> {
+				auto const* t = root_.get();
+				if (t == nullptr) {
+					return std::nullopt;
 				}
-				if (e->get_nodes().second == old_data) {
-					// replace edge that at distinat
-					auto& dst_edges = connect_[e->get_nodes().first];
-					for (auto& e_dst : dst_edges) {
-						if (e_dst->get_nodes().second == old_data) {
-							if (e_dst->is_weighted()) {
-								e_dst = std::make_shared<weighted_edge<N, E>>(e->get_nodes().first,
-								                                              new_data,
-								                                              *(e_dst->get_weight()));
-							}
-							else {
-								e_dst = std::make_shared<unweighted_edge<N, E>>(e->get_nodes().first, new_data);
-							}
-						}
-					}
-					dst_edges.erase(unique(dst_edges.begin(), dst_edges.end()), dst_edges.end());
-					sort(dst_edges.begin(), dst_edges.end(), gdwg::graph<N, E>::compareEdge);
-					if (e->is_weighted()) {
-						e = std::make_shared<weighted_edge<N, E>>(e->get_nodes().first, new_data, *(e->get_weight()));
-					}
-					else {
-						e = std::make_shared<unweighted_edge<N, E>>(e->get_nodes().first, new_data);
-					}
+				while (t->left) {
+					t = t->left.get();
 				}
+				return t->id;
 			}
 
-			// replace related edges start with src in connect
-			auto& all_edges = connect_[old_data];
-			for (auto& e : all_edges) {
-				if (e->is_weighted()) {
-					e = std::make_shared<weighted_edge<N, E>>(new_data, e->get_nodes().second, *(e->get_weight()));
+			[[nodiscard]] auto last() const -> std::optional<node_id> {
+				auto const* t = root_.get();
+				if (t == nullptr) {
+					return std::nullopt;
 				}
-				else {
-					e = std::make_shared<unweighted_edge<N, E>>(new_data, e->get_nodes().second);
+				while (t->right) {
+					t = t->right.get();
 				}
+				return t->id;
 			}
-			connect_[new_data] = std::move(connect_[old_data]);
-			connect_.erase(old_data);
-
-			// merge same edge
-			connect_[new_data].erase(unique(connect_[new_data].begin(), connect_[new_data].end()),
-			                         connect_[new_data].end());
-			edges_.erase(unique(edges_.begin(), edges_.end()), edges_.end());
-			sort(connect_[new_data].begin(), connect_[new_data].end(), gdwg::graph<N, E>::compareEdge);
-			sort(edges_.begin(), edges_.end(), gdwg::graph<N, E>::compareEdge);
-		}
 
-		auto erase_node(N const& value) -> bool {
-			if (!is_node(value)) {
-				return false;
+			[[nodiscard]] auto next(node_id id) const -> std::optional<node_id> {
+				return next_[id] == none ? std::nullopt : std::optional(next_[id]);
 			}
 
-			// remove from edge that at distination
-			for (auto& n : nodes_) {
-				auto& es = connect_[n];
-				es.erase(std::remove_if(es.begin(),
-				                        es.end(),
-				                        [&value](const auto es) -> bool { return es->get_nodes().second == value; }),
-				         es.end());
-			}
-
-			// remove from edges_
-			edges_.erase(std::remove_if(edges_.begin(),
-			                            edges_.end(),
-			                            [&value](const auto edges_) -> bool {
-				                            return edges_->get_nodes().first == value
-				                                   || edges_->get_nodes().second == value;
-			                            }),
-			             edges_.end());
-			// remove all edge related
-			auto& erase_edges = connect_[value];
-			erase_edges.clear();
-			// erase node
-			nodes_.erase(value);
-			return true;
-		}
-
-		auto erase_edge(N const& src, N const& dst, std::optional<E> weight = std::nullopt) -> bool {
-			// check whether is node
-			if (!is_node(src) || !is_node(dst)) {
-				throw std::runtime_error("Cannot call gdwg::graph<N, E>::erase_edge on src or dst if they don't exist "
-				                         "in the "
-				                         "graph");
-			}
-			// loop throw related edges
-			auto src_edges = connect_.find(src);
-			// if node have no edge
-			if (src_edges == connect_.end()) {
-				std::cout << "n\n";
-				return false;
-			}
-			// find edge exist
-			auto edge_it =
-			    std::find_if(src_edges->second.begin(), src_edges->second.end(), [&dst, &weight](const auto& e) {
-				    return e->get_nodes().second == dst && (!weight || e->get_weight() == weight);
-			    });
-			// if not exist
-			if (edge_it == src_edges->second.end()) {
-				return false;
+			[[nodiscard]] auto prev(node_id id) const -> std::optional<node_id> {
+				return prev_[id] == none ? std::nullopt : std::optional(prev_[id]);
 			}
-			// erase edge
-			src_edges->second.erase(edge_it);
-			// remove from edges_
-			edges_.erase(std::remove_if(edges_.begin(),
-			                            edges_.end(),
-			                            [&src, &dst, &weight](const auto edges_) -> bool {
-				                            return edges_->get_nodes().first == src && edges_->get_nodes().second == dst
-				                                   && edges_->get_weight() == weight;
-			                            }),
-			             edges_.end());
-			return true;
-		}
 
-		auto erase_edge(iterator i) -> iterator {
-			if (i == end()) {
-				return end();
+			// call f(id) for every node in sorted order
+			template<typename F>
+			auto for_each(F f) const -> void {
+				auto path = std::vector<tree_node const*>();
+				for (auto const* t = root_.get(); t != nullptr || !path.empty();) {
+					if (t != nullptr) {
+						path.push_back(t);
+						t = t->left.get();
+						continue;
+					}
+					t = path.back();
+					path.pop_back();
+					f(t->id);
+					t = t->right.get();
+				}
 			}
-			std::string from = (*i).from;
-			std::string to = (*i).to;
-			int weight = (*i).weight.value();
-			for (auto& e : edges_) {
-				if ((*i).from == e->get_nodes().first && (*i).to == e->get_nodes().second
-				    && (*i).weight.value() == e->get_weight().value())
-				{
-					erase_edge(from, to, weight);
-					break;
+
+		 private:
+			struct tree_node {
+				N const* key;
+				node_id id;
+				std::size_t height;
+				std::shared_ptr<tree_node> left;
+				std::shared_ptr<tree_node> right;
+			};
+			using subtree = std::shared_ptr<tree_node>;
+
+			static constexpr node_id none = std::numeric_limits<node_id>::max();
+
+			subtree root_;
+			std::size_t size_ = 0;
+			// id -> the id before and after it in sorted order, none at either end
+			detail::cow_array<node_id> next_;
+			detail::cow_array<node_id> prev_;
+
+			// make a and b neighbours, either may be none
+			auto link(node_id a, node_id b) -> void {
+				if (a != none) {
+					put(next_, a, b);
+				}
+				if (b != none) {
+					put(prev_, b, a);
 				}
 			}
-			return i;
-		}
 
-		auto erase_edge(iterator i, iterator s) -> iterator {
-			N from = (*s).from;
-			N to = (*s).to;
-			E weight = (*s).weight.value();
-			while (i != end()) {
-				if ((*i).weight.value() == weight && (*i).from == from && (*i).to == to) {
-					break;
+			static auto put(detail::cow_array<node_id>& ids, node_id at, node_id value) -> void {
+				while (ids.size() <= at) {
+					ids.push_back(none);
 				}
-				i = erase_edge(i);
+				ids.write(at) = value;
 			}
-			return i;
-		}
 
-		auto clear() noexcept -> void {
-			nodes_.clear();
-			connect_.clear();
-			edges_.clear();
-		}
+			// the node, copied first if another tree still shares it
+			static auto own(subtree& t) -> tree_node& {
+				if (t.use_count() > 1) {
+					t = std::make_shared<tree_node>(*t);
+				}
+				return *t;
+			}
 
-		/////////////////////////////
-		////////  Accessors  ////////
-		/////////////////////////////
+			static auto height(subtree const& t) -> std::size_t {
+				return t ? t->height : 0;
+			}
 
-		[[nodiscard]] auto is_node(N const& value) const -> bool {
-			return nodes_.find(value) != nodes_.end();
-		}
+			static auto update(tree_node& t) -> void {
+				t.height = 1 + std::max(height(t.left), height(t.right));
+			}
 
-		[[nodiscard]] auto empty() const -> bool {
-			return nodes_.empty();
-		}
+			static auto rotate_right(subtree& t) -> void {
+				auto& top = own(t);
+				auto l = std::move(top.left);
+				auto& up = own(l);
+				top.left = std::move(up.right);
+				update(top);
+				up.right = std::move(t);
+				update(up);
+				t = std::move(l);
+			}
 
-		[[nodiscard]] auto is_connected(N const& src, N const& dst) const -> bool {
-			if (!is_node(src) || !is_node(dst)) {
-				throw std::runtime_error("Cannot call gdwg::graph<N, E>::is_connected if src or dst node don't exist "
-				                         "in the "
-				                         "graph");
+			static auto rotate_left(subtree& t) -> void {
+				auto& top = own(t);
+				auto r = std::move(top.right);
+				auto& up = own(r);
+				top.right = std::move(up.left);
+				update(top);
+				up.left = std::move(t);
+				update(up);
+				t = std::move(r);
 			}
-			auto it = connect_.find(src);
-			if (it != connect_.end()) {
-				for (const auto& edge_ptr : it->second) {
-					if (edge_ptr->get_nodes().second == dst) {
-						return true;
+
+			// restore the height difference of at most one below an owned node
+			static auto balance(subtree& t) -> void {
+				auto& n = *t;
+				update(n);
+				if (height(n.left) > height(n.right) + 1) {
+					if (height(n.left->left) < height(n.left->right)) {
+						rotate_left(n.left);
+					}
+					rotate_right(t);
+				}
+				else if (height(n.right) > height(n.left) + 1) {
+					if (height(n.right->right) < height(n.right->left)) {
+						rotate_right(n.right);
 					}
+					rotate_left(t);
 				}
 			}
-			return false;
-		}
-
-		[[nodiscard]] auto nodes() const -> std::vector<N> {
-			auto result = std::vector<N>(nodes_.begin(), nodes_.end());
-			sort(result.begin(), result.end());
-			return result;
-		}
 
-		[[nodiscard]] auto edges(N const& src, N const& dst) const -> std::vector<std::unique_ptr<edge>> {
-			if (!is_node(src) || !is_node(dst)) {
-				throw std::runtime_error("Cannot call gdwg::graph<N, E>::edges if src or dst node don't exist in the "
-				                         "graph");
+			// before and after end up as the ids next to key in order
+			static auto insert(subtree& t, N const* key, node_id id, node_id& before, node_id& after) -> void {
+				if (!t) {
+					t = std::make_shared<tree_node>(tree_node{key, id, 1, nullptr, nullptr});
+					return;
+				}
+				auto& n = own(t);
+				if (*key < *n.key) {
+					after = n.id;
+					insert(n.left, key, id, before, after);
+				}
+				else {
+					before = n.id;
+					insert(n.right, key, id, before, after);
+				}
+				balance(t);
 			}
-			auto src_edges = connect_.find(src);
-			std::vector<std::unique_ptr<edge>> result;
-			if (src_edges != connect_.end()) {
-				for (const auto& e : src_edges->second) {
-					if (e->get_nodes().second == dst) {
-						std::unique_ptr<edge> uni_e;
-						if (e->is_weighted()) {
-							uni_e = std::make_unique<weighted_edge<N, E>>(e->get_nodes().first,
-							                                              e->get_nodes().second,
-							                                              *(e->get_weight()));
-						}
-						else {
-							uni_e = std::make_unique<unweighted_edge<N, E>>(e->get_nodes().first, e->get_nodes().second);
-						}
-						result.push_back(std::move(uni_e));
-					}
+
+			static auto erase(subtree& t, N const& value) -> void {
+				auto& n = own(t);
+				if (value < *n.key) {
+					erase(n.left, value);
 				}
-				sort(result.begin(), result.end(), [](const auto& a, const auto& b) {
-					// if a is unweighted
-					if (!a->is_weighted() && b->is_weighted())
-						return true;
-					// if b is unweighted
-					if (a->is_weighted() && !b->is_weighted())
-						return false;
-					// if both weighted, then compared
-					if (a->is_weighted() && b->is_weighted()) {
-						return a->get_weight() < b->get_weight();
+				else if (*n.key < value) {
+					erase(n.right, value);
+				}
+				else if (!n.left || !n.right) {
+					t = std::move(n.left ? n.left : n.right);
+					return;
+				}
+				else {
+					// the successor takes this node's place
+					auto const* min = n.right.get();
+					while (min->left) {
+						min = min->left.get();
 					}
-					return false;
-				});
+					n.key = min->key;
+					n.id = min->id;
+					erase(n.right, *n.key);
+				}
+				balance(t);
 			}
-			return result;
-		}
+		};
+	};
 
-		[[nodiscard]] auto find(N const& src, N const& dst, std::optional<E> weight = std::nullopt) -> iterator {
-			auto src_edges = connect_.find(src);
-			// check exist edge
-			if (src_edges != connect_.end()) {
-				auto e = src_edges->second.begin();
-				while (e != src_edges->second.end()) {
-					if ((*e)->get_nodes().second == dst) {
-						// whether weighted or unweighted
-						auto node_it = nodes_.find(src);
-						if (weight == std::nullopt && !(*e)->is_weighted()) {
-							return gdwg::graph<N, E>::iterator(const_cast<graph<N, E>*>(this), node_it, e);
-						}
-						if (weight != std::nullopt && (*e)->is_weighted() && (*e)->get_weight() == weight) {
-							return gdwg::graph<N, E>::iterator(const_cast<graph<N, E>*>(this), node_it, e);
-						}
-					}
-					e++;
+	// open addressing hash table with linear probing for O(1) point lookups. The slots
+	// sit in a cow_array, so a write after a copy duplicates only the slot pages it
+	// probes. Sorted order is only built when something walks the nodes in order, and
+	// is kept, shared with copies, until the next insert or erase.
+	struct hashed_index {
+		template<typename N>
+		class type {
+		 public:
+			static constexpr bool sorted_lookups = false;
+
+			type() = default;
+
+			type(type const& other)
+			: slots_(other.slots_)
+			, size_(other.size_) {
+				auto const lock = std::scoped_lock(other.sorted_mutex_);
+				sorted_ = other.sorted_;
+				sorted_valid_.store(other.sorted_valid_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+			}
+
+			auto operator=(type const& other) -> type& {
+				if (this != &other) {
+					*this = type(other);
 				}
+				return *this;
 			}
-			return end();
-		}
 
-		[[nodiscard]] auto connections(N const& src) const -> std::vector<N> {
-			if (!is_node(src)) {
-				throw std::runtime_error("Cannot call gdwg::graph<N, E>::connections if src doesn't exist in the "
-				                         "graph");
+			type(type&& other) noexcept
+			: slots_(std::move(other.slots_))
+			, size_(std::exchange(other.size_, 0))
+			, sorted_valid_(other.sorted_valid_.exchange(false, std::memory_order_relaxed))
+			, sorted_(std::move(other.sorted_)) {}
+
+			auto operator=(type&& other) noexcept -> type& {
+				slots_ = std::move(other.slots_);
+				size_ = std::exchange(other.size_, 0);
+				sorted_valid_.store(other.sorted_valid_.exchange(false, std::memory_order_relaxed),
+				                    std::memory_order_relaxed);
+				sorted_ = std::move(other.sorted_);
+				return *this;
 			}
-			std::vector<N> connected_nodes;
-			for (auto& e : edges_) {
-				if (e->get_nodes().first == src) {
-					connected_nodes.push_back(e->get_nodes().second);
+
+			[[nodiscard]] auto find(N const& value) const -> std::optional<node_id> {
+				if (size_ == 0) {
+					return std::nullopt;
 				}
-				if (e->get_nodes().second == src) {
-					connected_nodes.push_back(e->get_nodes().first);
+				auto const hash = std::hash<N>{}(value);
+				for (auto i = hash & mask();; i = (i + 1) & mask()) {
+					auto const& s = slots_[i];
+					if (s.value == nullptr) {
+						return std::nullopt;
+					}
+					if (s.hash == hash && *s.value == value) {
+						return s.id;
+					}
 				}
 			}
-			sort(connected_nodes.begin(), connected_nodes.end());
-			connected_nodes.erase(unique(connected_nodes.begin(), connected_nodes.end()), connected_nodes.end());
-			return connected_nodes;
-		}
 
-		/////////////////////////
-		//// Iterator Access ////
-		/////////////////////////
+			auto insert(N const& value, node_id id) -> void {
+				// keep load factor under 3/4
+				if ((size_ + 1) * 4 > slots_.size() * 3) {
+					rehash(std::max(std::size_t{16}, slots_.size() * 2));
+				}
+				place(slot{&value, std::hash<N>{}(value), id});
+				++size_;
+				sorted_valid_.store(false, std::memory_order_relaxed);
+			}
 
-		[[nodiscard]] auto begin() const -> iterator {
-			// find first node
-			auto node_it = nodes_.begin();
-			if (node_it == nodes_.end()) {
-				return end();
+			auto erase(N const& value) -> void {
+				auto const hash = std::hash<N>{}(value);
+				auto hole = hash & mask();
+				while (slots_[hole].hash != hash || *slots_[hole].value != value) {
+					hole = (hole + 1) & mask();
+				}
+				// backward shift, pull later entries of the cluster into the hole
+				// unless that would move them in front of their home slot
+				for (auto i = (hole + 1) & mask(); slots_[i].value != nullptr; i = (i + 1) & mask()) {
+					auto const home = slots_[i].hash & mask();
+					if (((i - home) & mask()) >= ((i - hole) & mask())) {
+						slots_.write(hole) = slots_[i];
+						hole = i;
+					}
+				}
+				slots_.write(hole) = slot{};
+				--size_;
+				sorted_valid_.store(false, std::memory_order_relaxed);
 			}
-			while (node_it != nodes_.end() && connect_.count(*node_it) == 0) {
-				++node_it;
+
+			[[nodiscard]] auto size() const -> std::size_t {
+				return size_;
 			}
-			auto edge_it = connect_.find(*node_it);
-			if (edge_it == connect_.end()) {
-				return end();
+
+			[[nodiscard]] auto empty() const -> bool {
+				return size_ == 0;
 			}
-			return iterator(const_cast<graph<N, E>*>(this), node_it, edge_it->second.begin());
-		}
 
-		[[nodiscard]] auto end() const -> iterator {
-			return iterator(const_cast<graph<N, E>*>(this), nodes_.end(), edges_.end());
-		}
+			auto clear() noexcept -> void {
+				slots_.clear();
+				size_ = 0;
+				sorted_valid_.store(false, std::memory_order_relaxed);
+			}
 
-		////////////////////
-		//// Comparison ////
-		////////////////////
+			[[nodiscard]] auto first() const -> std::optional<node_id> {
+				auto const& order = sorted();
+				return order.ids.empty() ? std::nullopt : std::optional(order.ids.front());
+			}
 
-		[[nodiscard]] auto operator==(graph const& other) const -> bool {
-			// compare node
-			if (nodes_.size() != other.nodes_.size() || !std::equal(nodes_.begin(), nodes_.end(), other.nodes_.begin()))
-			{
-				return false;
+			[[nodiscard]] auto last() const -> std::optional<node_id> {
+				auto const& order = sorted();
+				return order.ids.empty() ? std::nullopt : std::optional(order.ids.back());
 			}
-			// check edge size same
-			if (edges_.size() != other.edges_.size()) {
-				return false;
+
+			[[nodiscard]] auto next(node_id id) const -> std::optional<node_id> {
+				auto const& order = sorted();
+				auto const rank = order.rank[id] + 1;
+				return rank < order.ids.size() ? std::optional(order.ids[rank]) : std::nullopt;
 			}
-			// check all element are same
-			return std::equal(edges_.begin(), edges_.end(), other.edges_.begin(), [](const auto& a, const auto& b) {
-				if (!a || !b)
+
+			[[nodiscard]] auto prev(node_id id) const -> std::optional<node_id> {
+				auto const& order = sorted();
+				auto const rank = order.rank[id];
+				return rank == 0 ? std::nullopt : std::optional(order.ids[rank - 1]);
+			}
+
+			template<typename F>
+			auto for_each(F f) const -> void {
+				for (auto const id : sorted().ids) {
+					f(id);
+				}
+			}
+
+		 private:
+			struct slot {
+				N const* value = nullptr;
+				std::size_t hash = 0;
+				node_id id = 0;
+			};
+
+			// sorted ids and id -> position in them
+			struct order {
+				std::vector<node_id> ids;
+				std::vector<std::size_t> rank;
+			};
+
+			// pages of 512 slots, larger than the default so a probe crosses fewer branches
+			static constexpr std::size_t slot_page_bits = 9;
+			detail::cow_array<slot, slot_page_bits> slots_;
+			std::size_t size_ = 0;
+			// rebuilt under the lock so that concurrent const readers can ask for the order
+			mutable std::mutex sorted_mutex_;
+			mutable std::atomic<bool> sorted_valid_ = false;
+			mutable std::shared_ptr<order const> sorted_;
+
+			auto mask() const -> std::size_t {
+				return slots_.size() - 1;
+			}
+
+			auto place(slot const& s) -> void {
+				auto i = s.hash & mask();
+				while (slots_[i].value != nullptr) {
+					i = (i + 1) & mask();
+				}
+				slots_.write(i) = s;
+			}
+
+			auto rehash(std::size_t capacity) -> void {
+				auto old = std::exchange(slots_, detail::cow_array<slot, slot_page_bits>(capacity, slot{}));
+				for (auto i = std::size_t{0}; i < old.size(); ++i) {
+					if (old[i].value != nullptr) {
+						place(old[i]);
+					}
+				}
+			}
+
+			auto sorted() const -> order const& {
+				if (sorted_valid_.load(std::memory_order_acquire)) {
+					return *sorted_;
+				}
+				auto const lock = std::scoped_lock(sorted_mutex_);
+				if (!sorted_valid_.load(std::memory_order_relaxed)) {
+					auto entries = std::vector<slot>();
+					entries.reserve(size_);
+					for (auto i = std::size_t{0}; i < slots_.size(); ++i) {
+						if (slots_[i].value != nullptr) {
+							entries.push_back(slots_[i]);
+						}
+					}
+					std::sort(entries.begin(), entries.end(), [](auto const& a, auto const& b) {
+						return *a.value < *b.value;
+					});
+					auto result = std::make_shared<order>();
+					for (auto const& s : entries) {
+						if (result->rank.size() <= s.id) {
+							result->rank.resize(s.id + std::size_t{1});
+						}
+						result->rank[s.id] = result->ids.size();
+						result->ids.push_back(s.id);
+					}
+					sorted_ = std::move(result);
+					sorted_valid_.store(true, std::memory_order_release);
+				}
+				return *sorted_;
+			}
+		};
+	};
+
+	namespace detail {
+		// Output text gathered in a reusable buffer and written to the stream in large
+		// blocks, in place of a std::string built for every line
+		class text_buffer {
+		 public:
+			// about when the owner should hand the buffer to the stream
+			static constexpr std::size_t flush_size = std::size_t{1} << 16;
+
+			auto append(std::string_view text) -> void {
+				data_ += text;
+			}
+
+			auto append(text_buffer const& other) -> void {
+				data_ += other.data_;
+			}
+
+			// string-like values are copied in, anything else is formatted by its
+			// operator<< with the flags of format
+			template<typename T>
+			auto append_value(T const& value, std::ostream const& format) -> void {
+				if constexpr (std::is_convertible_v<T const&, std::string_view>) {
+					data_ += std::string_view(value);
+				}
+				else {
+					auto text = std::ostringstream();
+					text.copyfmt(format);
+					text << value;
+					data_ += text.view();
+				}
+			}
+
+			// what std::to_string writes: integers in decimal, floating point as "%f"
+			template<typename E>
+			    requires std::is_arithmetic_v<E>
+			auto append_number(E value) -> void {
+				if constexpr (std::is_same_v<E, bool>) {
+					data_ += value ? '1' : '0';
+				}
+				else if constexpr (std::is_floating_point_v<E>) {
+					// fixed notation of the largest value, sign, point and 6 decimals
+					auto chars = std::array<char, std::numeric_limits<E>::max_exponent10 + 16>();
+					auto const result =
+					    std::to_chars(chars.data(), chars.data() + chars.size(), value, std::chars_format::fixed, 6);
+					data_.append(chars.data(), result.ptr);
+				}
+				else {
+					auto chars = std::array<char, std::numeric_limits<E>::digits10 + 3>();
+					auto const result = std::to_chars(chars.data(), chars.data() + chars.size(), value);
+					data_.append(chars.data(), result.ptr);
+				}
+			}
+
+			[[nodiscard]] auto size() const -> std::size_t {
+				return data_.size();
+			}
+
+			auto clear() noexcept -> void {
+				data_.clear();
+			}
+
+			// writes everything out and empties the buffer, keeping its capacity
+			auto write_to(std::ostream& os) -> void {
+				os.write(data_.data(), static_cast<std::streamsize>(data_.size()));
+				data_.clear();
+			}
+
+		 private:
+			std::string data_;
+		};
+	} // namespace detail
+
+	///////////////////////////////////////////
+	//**********    Graph Class    **********//
+	///////////////////////////////////////////
+
+	// Index selects how nodes are looked up, ordered_index or hashed_index. Iteration,
+	// nodes() and printing are in sorted node order with either policy.
+	template<typename N, typename E, typename Index>
+	class graph {
+	 public:
+		class iterator;
+		using edge = gdwg::edge<N, E>;
+
+		// Your member functions go here
+
+		////////  Constructor  ////////
+		graph() noexcept = default;
+
+		// initial list
+		graph(std::initializer_list<N> il)
+		: graph(il.begin(), il.end()) {}
+
+		// input Iterator
+		template<typename InputIt>
+		graph(InputIt first, InputIt last) {
+			for (auto it = first; it != last; ++it) {
+				insert_node(*it);
+			}
+		}
+
+		// move constructor
+		graph(graph&& other) noexcept {
+			*this = std::move(other);
+		}
+
+		// move operator
+		auto operator=(graph&& other) noexcept -> graph& {
+			if (this != &other) {
+				values_ = std::move(other.values_);
+				free_ = std::move(other.free_);
+				ids_ = std::move(other.ids_);
+				out_ = std::move(other.out_);
+				in_ = std::move(other.in_);
+				dag_ = std::move(other.dag_);
+				other.clear();
+			}
+			return *this;
+		}
+
+		// copy constructor
+		graph(graph const& other) {
+			*this = other;
+		}
+
+		// copy operator, O(1): both graphs share storage until one of them writes. A
+		// write then duplicates the adjacency list or node value it changes, the storage
+		// page holding it and the O(log V) index and directory nodes above them.
+		auto operator=(graph const& other) -> graph& {
+			values_ = other.values_;
+			free_ = other.free_;
+			ids_ = other.ids_;
+			out_ = other.out_;
+			in_ = other.in_;
+			dag_ = other.dag_;
+			return *this;
+		}
+
+		/////////////////////////////
+		////////  Modifiers  ////////
+		/////////////////////////////
+
+		auto insert_node(N const& value) -> bool {
+			if (ids_.find(value)) {
+				return false;
+			}
+			add_node(value);
+			return true;
+		}
+
+		auto insert_edge(N const& src, N const& dst, std::optional<E> weight = std::nullopt) -> bool {
+			// check src and dst are node
+			auto const src_id = ids_.find(src);
+			auto const dst_id = ids_.find(dst);
+			if (!src_id || !dst_id) {
+				throw std::runtime_error("Cannot call gdwg::graph<N, E>::insert_edge when either src or dst node does "
+				                         "not "
+				                         "exist");
+			}
+			dag_link(*src_id, *dst_id);
+			return insert_record(edge_record{*src_id, *dst_id, weight});
+		}
+
+		// bulk load (src, dst, weight) tuples, returns how many edges were new
+		template<std::ranges::input_range R>
+		auto insert_edges(R&& edges) -> std::size_t {
+			return insert_edges(std::ranges::begin(edges), std::ranges::end(edges));
+		}
+
+		template<typename InputIt, typename Sentinel>
+		auto insert_edges(InputIt first, Sentinel last) -> std::size_t {
+			// check every src and dst is node before changing anything
+			if constexpr (node_index::sorted_lookups && names_in_place<InputIt>) {
+				return insert_records(resolve_sorted(first, last));
+			}
+			// batches are mostly grouped by src, so the last names found are tried first
+			std::vector<edge_record> records;
+			auto src_id = node_id{0};
+			auto dst_id = node_id{0};
+			N const* src_value = nullptr;
+			N const* dst_value = nullptr;
+			auto const resolve = [this](N const& value, node_id& id, N const*& cached) {
+				if (cached != nullptr && *cached == value) {
+					return true;
+				}
+				auto const found = ids_.find(value);
+				if (!found) {
 					return false;
-				return a->get_nodes() == b->get_nodes() && a->get_weight() == b->get_weight();
+				}
+				id = *found;
+				cached = &values_[id];
+				return true;
+			};
+			for (auto it = first; it != last; ++it) {
+				auto const& [src, dst, weight] = *it;
+				if (!resolve(src, src_id, src_value) || !resolve(dst, dst_id, dst_value)) {
+					throw missing_edge_node();
+				}
+				records.push_back(edge_record{src_id, dst_id, std::optional<E>(weight)});
+			}
+			return insert_records(std::move(records));
+		}
+
+		auto replace_node(N const& old_data, N const& new_data) -> bool {
+			if (!is_node(old_data)) {
+				throw std::runtime_error("Cannot call gdwg::graph<N, E>::replace_node on a node that doesn't exist");
+			}
+			if (ids_.find(new_data)) {
+				return false;
+			}
+
+			// edges refer to the id, so only the value changes, but the edges ending
+			// at the node have to move to their new sorted place in each source
+			auto const id = *ids_.find(old_data);
+			auto runs = std::vector<std::vector<edge_record>>();
+			for_each_source(id, [&](node_id src) {
+				auto& es = out_.write(src);
+				auto const [first, last] = dst_range(es, id);
+				runs.emplace_back(first, last);
+				es.erase(first, last);
 			});
+
+			// replace node, the key must leave the index before its value changes
+			ids_.erase(values_[id]);
+			values_.write(id) = new_data;
+			ids_.insert(values_[id], id);
+
+			for (auto& run : runs) {
+				auto& es = out_.write(run.front().src);
+				es.insert(dst_range(es, id).first, run.begin(), run.end());
+			}
+			return true;
+		}
+
+		auto merge_replace_node(N const& old_data, N const& new_data) -> void {
+			if (!is_node(old_data) || !is_node(new_data)) {
+				throw std::runtime_error("Cannot call gdwg::graph<N, E>::replace_node on a node that doesn't exist");
+			}
+			auto const old_id = *ids_.find(old_data);
+			auto const new_id = *ids_.find(new_data);
+			if (old_id == new_id) {
+				return;
+			}
+			// any path between the two becomes a cycle through the merged node
+			if (dag_ && (dag_reaches(old_id, new_id) || dag_reaches(new_id, old_id))) {
+				throw std::runtime_error("Cannot call gdwg::graph<N, E>::merge_replace_node when the merge would "
+				                         "create a cycle in dag mode");
+			}
+
+			// collect outgoing edges of old node, self loop becomes new node loop
+			auto moved = std::vector<edge_record>();
+			for (auto const& e : out_[old_id]) {
+				if (e.dst != old_id) {
+					erase_source(e.dst, old_id);
+				}
+				moved.push_back(edge_record{new_id, e.dst == old_id ? new_id : e.dst, e.weight});
+			}
+			// collect edges that end at old node from the reverse index
+			for_each_source(old_id, [&](node_id src) {
+				if (src == old_id) {
+					return;
+				}
+				auto& es = out_.write(src);
+				auto const [first, last] = dst_range(es, old_id);
+				for (auto e = first; e != last; ++e) {
+					moved.push_back(edge_record{src, new_id, e->weight});
+				}
+				es.erase(first, last);
+			});
+
+			// replace node
+			out_.write(old_id).clear();
+			in_.write(old_id).clear();
+			ids_.erase(values_[old_id]);
+			free_.push_back(old_id);
+
+			// merge same edge
+			for (auto const& e : moved) {
+				insert_record(e);
+			}
+			if (dag_) {
+				reset_dag(*topological_ids());
+			}
+		}
+
+		auto erase_node(N const& value) -> bool {
+			auto const node = ids_.find(value);
+			if (!node) {
+				return false;
+			}
+			auto const id = *node;
+
+			// remove from edge that at distination
+			for_each_source(id, [&](node_id src) {
+				auto& es = out_.write(src);
+				auto const [first, last] = dst_range(es, id);
+				es.erase(first, last);
+			});
+			for (auto const& e : out_[id]) {
+				if (e.dst != id) {
+					erase_source(e.dst, id);
+				}
+			}
+			// remove all edge related, the id is handed to the next new node
+			out_.write(id).clear();
+			in_.write(id).clear();
+			ids_.erase(values_[id]);
+			free_.push_back(id);
+			return true;
+		}
+
+		auto erase_edge(N const& src, N const& dst, std::optional<E> weight = std::nullopt) -> bool {
+			// check whether is node
+			auto const src_id = ids_.find(src);
+			auto const dst_id = ids_.find(dst);
+			if (!src_id || !dst_id) {
+				throw std::runtime_error("Cannot call gdwg::graph<N, E>::erase_edge on src or dst if they don't exist "
+				                         "in the "
+				                         "graph");
+			}
+			// find edge exist, a shared adjacency is only copied once we know it changes
+			auto const& src_edges = out_[*src_id];
+			auto const edge_it = find_record(src_edges, edge_record{*src_id, *dst_id, weight});
+			// if not exist
+			if (edge_it == src_edges.end()) {
+				return false;
+			}
+			// erase edge
+			auto const pos = edge_it - src_edges.begin();
+			erase_source(*dst_id, *src_id);
+			auto& es = out_.write(*src_id);
+			es.erase(es.begin() + pos);
+			return true;
+		}
+
+		auto erase_edge(iterator i) -> iterator {
+			if (i == end()) {
+				return end();
+			}
+			// the next edge slides into the erased position
+			auto& es = out_.write(i.node_);
+			auto const edge_it = es.begin() + static_cast<std::ptrdiff_t>(i.edge_idx);
+			erase_source(edge_it->dst, edge_it->src);
+			es.erase(edge_it);
+			if (i.edge_idx == es.size()) {
+				i.next_node();
+			}
+			return i;
+		}
+
+		auto erase_edge(iterator i, iterator s) -> iterator {
+			// s shifts while erasing, so stop on the edge it points at
+			if (s == end()) {
+				while (i != end()) {
+					i = erase_edge(i);
+				}
+				return i;
+			}
+			auto const stop = *s;
+			while (i != end()) {
+				auto const cur = *i;
+				if (cur.weight == stop.weight && cur.from == stop.from && cur.to == stop.to) {
+					break;
+				}
+				i = erase_edge(i);
+			}
+			return i;
+		}
+
+		auto clear() noexcept -> void {
+			values_.clear();
+			free_.clear();
+			ids_.clear();
+			out_.clear();
+			in_.clear();
+			if (dag_) {
+				dag_ = std::make_shared<dag_order>();
+			}
+		}
+
+		// In dag mode the graph keeps a topological order of its nodes up to date and
+		// insert_edge throws instead of closing a cycle. Each insert only searches the
+		// nodes placed between the edge's two ends (Pearce-Kelly). Turning it on sorts
+		// the graph once and throws if it already has a cycle.
+		auto set_dag_mode(bool on) -> void {
+			if (!on) {
+				dag_.reset();
+				return;
+			}
+			if (dag_) {
+				return;
+			}
+			auto const order = topological_ids();
+			if (!order) {
+				throw std::runtime_error("Cannot call gdwg::graph<N, E>::set_dag_mode on a graph with a cycle");
+			}
+			reset_dag(*order);
+		}
+
+		/////////////////////////////
+		////////  Accessors  ////////
+		/////////////////////////////
+
+		[[nodiscard]] auto is_node(N const& value) const -> bool {
+			return ids_.find(value).has_value();
+		}
+
+		[[nodiscard]] auto empty() const -> bool {
+			return ids_.empty();
+		}
+
+		[[nodiscard]] auto is_connected(N const& src, N const& dst) const -> bool {
+			auto const src_id = ids_.find(src);
+			auto const dst_id = ids_.find(dst);
+			if (!src_id || !dst_id) {
+				throw std::runtime_error("Cannot call gdwg::graph<N, E>::is_connected if src or dst node don't exist "
+				                         "in the "
+				                         "graph");
+			}
+			auto const [first, last] = dst_range(out_[*src_id], *dst_id);
+			return first != last;
+		}
+
+		[[nodiscard]] auto dag_mode() const -> bool {
+			return dag_ != nullptr;
+		}
+
+		// nodes ordered so every edge points forward. A sort of the kept order in dag
+		// mode, otherwise a fresh Kahn sort that breaks ties by node order.
+		[[nodiscard]] auto topological_order() const -> std::vector<N> {
+			auto ids = std::vector<node_id>();
+			if (dag_) {
+				ids = sorted_ids();
+				std::sort(ids.begin(), ids.end(), [this](node_id a, node_id b) { return dag_->ord[a] < dag_->ord[b]; });
+			}
+			else {
+				auto order = topological_ids();
+				if (!order) {
+					throw std::runtime_error("Cannot call gdwg::graph<N, E>::topological_order on a graph with a "
+					                         "cycle");
+				}
+				ids = std::move(*order);
+			}
+			auto result = std::vector<N>();
+			result.reserve(ids.size());
+			for (auto const id : ids) {
+				result.push_back(values_[id]);
+			}
+			return result;
+		}
+
+		[[nodiscard]] auto nodes() const -> std::vector<N> {
+			auto result = std::vector<N>();
+			result.reserve(ids_.size());
+			ids_.for_each([&](node_id id) { result.push_back(values_[id]); });
+			return result;
+		}
+
+		[[nodiscard]] auto edges(N const& src, N const& dst) const -> std::vector<std::unique_ptr<edge>> {
+			if (!is_node(src) || !is_node(dst)) {
+				throw std::runtime_error("Cannot call gdwg::graph<N, E>::edges if src or dst node don't exist in the "
+				                         "graph");
+			}
+			std::vector<std::unique_ptr<edge>> result;
+			for (auto const& e : edges_view(src, dst)) {
+				result.push_back(make_edge(e));
+			}
+			return result;
+		}
+
+		// same edges as edges(), as a lazy range of edge_view with no allocation or copy
+		[[nodiscard]] auto edges_view(N const& src, N const& dst) const {
+			auto const src_id = ids_.find(src);
+			auto const dst_id = ids_.find(dst);
+			if (!src_id || !dst_id) {
+				throw std::runtime_error("Cannot call gdwg::graph<N, E>::edges_view if src or dst node don't exist in "
+				                         "the graph");
+			}
+			// the run is sorted unweighted first, then by weight
+			auto const [first, last] = dst_range(out_[*src_id], *dst_id);
+			return std::span<edge_record const>(first, last)
+			       | std::views::transform([this](edge_record const& e) { return view(e); });
+		}
+
+		[[nodiscard]] auto find(N const& src, N const& dst, std::optional<E> weight = std::nullopt) -> iterator {
+			auto const src_id = ids_.find(src);
+			auto const dst_id = ids_.find(dst);
+			// check exist edge
+			if (src_id && dst_id) {
+				auto const& es = out_[*src_id];
+				auto const e = find_record(es, edge_record{*src_id, *dst_id, weight});
+				if (e != es.end()) {
+					return iterator(this, *src_id, static_cast<std::size_t>(e - es.begin()));
+				}
+			}
+			return end();
+		}
+
+		[[nodiscard]] auto connections(N const& src) const -> std::vector<N> {
+			auto const src_id = ids_.find(src);
+			if (!src_id) {
+				throw std::runtime_error("Cannot call gdwg::graph<N, E>::connections if src doesn't exist in the "
+				                         "graph");
+			}
+			auto const id = *src_id;
+			std::vector<N> connected_nodes;
+			for (auto const& e : out_[id]) {
+				connected_nodes.push_back(values_[e.dst]);
+			}
+			for_each_source(id, [&](node_id n) { connected_nodes.push_back(values_[n]); });
+			sort(connected_nodes.begin(), connected_nodes.end());
+			connected_nodes.erase(unique(connected_nodes.begin(), connected_nodes.end()), connected_nodes.end());
+			return connected_nodes;
+		}
+
+		/////////////////////////
+		//// Iterator Access ////
+		/////////////////////////
+
+		[[nodiscard]] auto begin() const -> iterator {
+			// find first node with edges
+			auto id = ids_.first();
+			while (id && out_[*id].empty()) {
+				id = ids_.next(*id);
+			}
+			return iterator(this, id.value_or(no_node), 0);
+		}
+
+		[[nodiscard]] auto end() const -> iterator {
+			return iterator(this, no_node, 0);
+		}
+
+		////////////////////
+		////  Snapshot  ////
+		////////////////////
+
+		// build an immutable CSR copy for read-heavy workloads
+		[[nodiscard]] auto freeze() const -> csr_graph<N, E>;
+
+		////////////////////
+		//// Comparison ////
+		////////////////////
+
+		[[nodiscard]] auto operator==(graph const& other) const -> bool {
+			// compare node
+			if (ids_.size() != other.ids_.size()) {
+				return false;
+			}
+			// ids differ between graphs, so compare edges by value
+			auto same = [&](auto const& a, auto const& b) {
+				return values_[a.dst] == other.values_[b.dst] && a.weight == b.weight;
+			};
+			auto const ids = sorted_ids();
+			auto const other_ids = other.sorted_ids();
+			for (auto i = std::size_t{0}; i < ids.size(); ++i) {
+				auto const& es = out_[ids[i]];
+				auto const& other_es = other.out_[other_ids[i]];
+				if (values_[ids[i]] != other.values_[other_ids[i]]
+				    || !std::equal(es.begin(), es.end(), other_es.begin(), other_es.end(), same))
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+
+		///////////////////
+		//// Extractor ////
+		///////////////////
+
+		// Same text as print_edge() for every edge, unweighted edges of a node first, but
+		// formatted into one buffer in a single pass over each node's edges. Weighted
+		// lines wait in a second buffer until the node's unweighted lines are out.
+		friend auto operator<<(std::ostream& os, graph const& g) -> std::ostream& {
+			auto out = detail::text_buffer();
+			auto weighted = detail::text_buffer();
+			auto const& values = g.values_;
+			g.ids_.for_each([&](node_id id) {
+				auto const& src = values[id];
+				out.append_value(src, os);
+				out.append(" (");
+				for (auto const& e : g.out_[id]) {
+					auto& line = e.weight ? weighted : out;
+					line.append("\n  ");
+					line.append_value(src, os);
+					line.append(" -> ");
+					line.append_value(values[e.dst], os);
+					if (e.weight) {
+						line.append(" | W | ");
+						line.append_number(*e.weight);
+					}
+					else {
+						line.append(" | U");
+					}
+				}
+				out.append(weighted);
+				weighted.clear();
+				out.append("\n)\n");
+				if (out.size() >= detail::text_buffer::flush_size) {
+					out.write_to(os);
+				}
+			});
+			out.write_to(os);
+			return os;
+		}
+
+	 private:
+		// builds graphs by node id for the text readers in gdwg_graph_io.h
+		friend struct detail::graph_builder;
+
+		// edges are plain values, polymorphic edge objects only exist at the public boundary
+		struct edge_record {
+			node_id src;
+			node_id dst;
+			std::optional<E> weight;
+		};
+
+		using node_index = typename Index::template type<N>;
+		// iterator position past the last node
+		static constexpr node_id no_node = std::numeric_limits<node_id>::max();
+
+		// id -> node value, each value is stored only here and shared by copies
+		detail::cow_vector<N> values_;
+		// ids of erased nodes, their slot in values_ is stale until reused
+		detail::cow_array<node_id> free_;
+		// node value -> id, ordered so iteration follows node order
+		node_index ids_;
+		// id -> outgoing edges, sorted by compareEdge
+		detail::cow_vector<std::vector<edge_record>> out_;
+		// id -> source of every incoming edge, sorted, one entry per edge
+		detail::cow_vector<std::vector<node_id>> in_;
+
+		// position of every node in a topological order, only kept in dag mode
+		struct dag_order {
+			// id -> position, positions are distinct but need not be contiguous
+			std::vector<std::size_t> ord;
+			std::size_t next = 0;
+			// scratch for searches, all false between them
+			std::vector<bool> mark;
+		};
+		// null when dag mode is off, shared by copies and copied whole by a dag change
+		std::shared_ptr<dag_order> dag_;
+
+		// live ids in node order
+		auto sorted_ids() const -> std::vector<node_id> {
+			auto ids = std::vector<node_id>();
+			ids.reserve(ids_.size());
+			ids_.for_each([&](node_id id) { ids.push_back(id); });
+			return ids;
+		}
+
+		auto dag() -> dag_order& {
+			if (dag_.use_count() > 1) {
+				dag_ = std::make_shared<dag_order>(*dag_);
+			}
+			return *dag_;
+		}
+
+		// Kahn's sort of the live ids with the edges of extra (sorted by src) added,
+		// nullopt when there is a cycle. Ties go to the earlier node in node order.
+		auto topological_ids(std::span<edge_record const> extra = {}) const -> std::optional<std::vector<node_id>> {
+			auto const ids = sorted_ids();
+			auto indegree = std::vector<std::size_t>(values_.size());
+			for (auto const id : ids) {
+				indegree[id] = in_[id].size();
+			}
+			for (auto const& e : extra) {
+				++indegree[e.dst];
+			}
+			auto order = std::vector<node_id>();
+			order.reserve(ids.size());
+			for (auto const id : ids) {
+				if (indegree[id] == 0) {
+					order.push_back(id);
+				}
+			}
+			auto const release = [&](node_id dst) {
+				if (--indegree[dst] == 0) {
+					order.push_back(dst);
+				}
+			};
+			for (auto head = std::size_t{0}; head < order.size(); ++head) {
+				auto const u = order[head];
+				for (auto const& e : out_[u]) {
+					release(e.dst);
+				}
+				auto const [first, last] = std::equal_range(extra.begin(), extra.end(), u, src_less{});
+				for (auto e = first; e != last; ++e) {
+					release(e->dst);
+				}
+			}
+			if (order.size() != ids_.size()) {
+				return std::nullopt;
+			}
+			return order;
 		}
 
-		///////////////////
-		//// Extractor ////
-		///////////////////
+		auto reset_dag(std::vector<node_id> const& order) -> void {
+			auto d = std::make_shared<dag_order>();
+			d->ord.resize(values_.size());
+			d->mark.resize(values_.size());
+			for (auto i = std::size_t{0}; i < order.size(); ++i) {
+				d->ord[order[i]] = i;
+			}
+			d->next = order.size();
+			dag_ = std::move(d);
+		}
 
-		template<typename N_, typename E_>
-		friend auto operator<<(std::ostream& os, graph<N_, E_> const& g) -> std::ostream& {
-			for (const auto& node : g.nodes_) {
-				os << node;
-				// check node have edges
-				const auto& node_edges = g.connect_.find(node);
-				if (node_edges == g.connect_.end()) {
-					os << " (\n)\n";
-					continue;
-				}
-				os << " (";
-				// find unweighted edge
-				for (const auto& e : node_edges->second) {
-					if (!e->is_weighted() && e->get_nodes().first == node) {
-						os << "\n  " << e->print_edge();
+		// collect into seen the nodes reachable from start through positions below bound,
+		// marking each. Stops early and returns true once target is reached.
+		auto dag_forward(node_id start, std::size_t bound, node_id target, std::vector<node_id>& seen) -> bool {
+			auto& d = dag();
+			seen.push_back(start);
+			d.mark[start] = true;
+			for (auto i = std::size_t{0}; i < seen.size(); ++i) {
+				for (auto const& e : out_[seen[i]]) {
+					if (e.dst == target) {
+						return true;
+					}
+					if (!d.mark[e.dst] && d.ord[e.dst] < bound) {
+						d.mark[e.dst] = true;
+						seen.push_back(e.dst);
 					}
 				}
-				// output all edges
-				for (const auto& e : node_edges->second) {
-					if (e->is_weighted()) {
-						os << "\n  " << e->print_edge();
+			}
+			return false;
+		}
+
+		auto dag_unmark(std::vector<node_id> const& seen) -> void {
+			for (auto const id : seen) {
+				dag_->mark[id] = false;
+			}
+		}
+
+		// whether a path leads from a to b, only nodes placed between them can be on it
+		auto dag_reaches(node_id a, node_id b) -> bool {
+			if (dag_->ord[b] < dag_->ord[a]) {
+				return false;
+			}
+			auto seen = std::vector<node_id>();
+			auto const found = dag_forward(a, dag_->ord[b], b, seen);
+			dag_unmark(seen);
+			return found;
+		}
+
+		// Pearce-Kelly update for a new edge src -> dst. When dst is placed before src,
+		// search forward from dst and backward from src inside that window, then hand the
+		// window's positions to the backward set first. Throws before changing anything
+		// when the edge would close a cycle.
+		auto dag_link(node_id src, node_id dst) -> void {
+			if (!dag_) {
+				return;
+			}
+			auto const lower = dag_->ord[dst];
+			auto const upper = dag_->ord[src];
+			if (src != dst && upper < lower) {
+				return;
+			}
+			auto forward = std::vector<node_id>();
+			if (src == dst || dag_forward(dst, upper, src, forward)) {
+				dag_unmark(forward);
+				throw std::runtime_error("Cannot call gdwg::graph<N, E>::insert_edge when the edge would create a "
+				                         "cycle in dag mode");
+			}
+			auto& d = dag();
+			auto backward = std::vector<node_id>{src};
+			d.mark[src] = true;
+			for (auto i = std::size_t{0}; i < backward.size(); ++i) {
+				for (auto const s : in_[backward[i]]) {
+					if (!d.mark[s] && lower < d.ord[s]) {
+						d.mark[s] = true;
+						backward.push_back(s);
 					}
 				}
-				os << "\n)\n";
 			}
-			return os;
+			dag_unmark(forward);
+			dag_unmark(backward);
+
+			auto const by_ord = [&](node_id a, node_id b) { return d.ord[a] < d.ord[b]; };
+			std::sort(forward.begin(), forward.end(), by_ord);
+			std::sort(backward.begin(), backward.end(), by_ord);
+			auto slots = std::vector<std::size_t>();
+			slots.reserve(forward.size() + backward.size());
+			for (auto const id : backward) {
+				slots.push_back(d.ord[id]);
+			}
+			for (auto const id : forward) {
+				slots.push_back(d.ord[id]);
+			}
+			std::sort(slots.begin(), slots.end());
+			auto slot = slots.begin();
+			for (auto const id : backward) {
+				d.ord[id] = *slot++;
+			}
+			for (auto const id : forward) {
+				d.ord[id] = *slot++;
+			}
 		}
 
-	 private:
-		std::set<N> nodes_;
-		std::vector<std::shared_ptr<edge>> edges_;
-		std::map<N, std::vector<std::shared_ptr<edge>>> connect_;
-		static auto compareEdge(std::shared_ptr<edge>& a, std::shared_ptr<edge>& b) -> bool {
-			if (a->get_nodes().first == b->get_nodes().first) {
-				if (a->get_nodes().second == b->get_nodes().second) {
-					// if a is unweighted
-					if (!a->is_weighted() && b->is_weighted())
-						return true;
-					// if b is unweighted
-					if (a->is_weighted() && !b->is_weighted())
-						return false;
-					// if both weighted, then compared
-					if (a->is_weighted() && b->is_weighted()) {
-						return a->get_weight() < b->get_weight();
+		// orders adjacency entries against a bare source id
+		struct src_less {
+			auto operator()(edge_record const& e, node_id src) const -> bool {
+				return e.src < src;
+			}
+			auto operator()(node_id src, edge_record const& e) const -> bool {
+				return src < e.src;
+			}
+		};
+
+		// adds a node that isn't in the graph yet, returns its id
+		auto add_node(N const& value) -> node_id {
+			// reuse the id of an erased node if there is one
+			auto id = node_id{0};
+			if (free_.empty()) {
+				id = static_cast<node_id>(values_.size());
+				values_.push_back(value);
+				out_.push_back({});
+				in_.push_back({});
+			}
+			else {
+				id = free_.back();
+				free_.pop_back();
+				values_.write(id) = value;
+			}
+			ids_.insert(values_[id], id);
+			// a new node has no edges, so it can go last in the order
+			if (dag_) {
+				auto& d = dag();
+				if (d.ord.size() <= id) {
+					d.ord.resize(id + std::size_t{1});
+					d.mark.resize(id + std::size_t{1});
+				}
+				d.ord[id] = d.next++;
+			}
+			return id;
+		}
+
+		// a batch of tuples that hold their names as N lvalues, which stay put while sorted
+		template<typename It>
+		static constexpr bool names_in_place = std::forward_iterator<It> && requires(It it) {
+			requires std::same_as<decltype(std::get<0>(*it)), N&> || std::same_as<decltype(std::get<0>(*it)), N const&>;
+			requires std::same_as<decltype(std::get<1>(*it)), N&> || std::same_as<decltype(std::get<1>(*it)), N const&>;
+		};
+
+		static auto missing_edge_node() -> std::runtime_error {
+			return std::runtime_error("Cannot call gdwg::graph<N, E>::insert_edges when either src or dst node does "
+			                          "not exist");
+		}
+
+		// resolves a batch of (src, dst, weight) tuples for an index whose finds walk a
+		// tree. The names are sorted first, so each distinct name is found once, and the
+		// next distinct name is usually the found node's neighbour, one step away.
+		template<typename InputIt, typename Sentinel>
+		auto resolve_sorted(InputIt first, Sentinel last) const -> std::vector<edge_record> {
+			auto records = std::vector<edge_record>();
+			// name and the record end it resolves, 2 * record for src and one more for dst
+			auto names = std::vector<std::pair<N const*, std::size_t>>();
+			for (auto it = first; it != last; ++it) {
+				auto const& [src, dst, weight] = *it;
+				names.emplace_back(&src, 2 * records.size());
+				names.emplace_back(&dst, 2 * records.size() + 1);
+				records.push_back(edge_record{0, 0, std::optional<E>(weight)});
+			}
+			std::sort(names.begin(), names.end(), [](auto const& a, auto const& b) { return *a.first < *b.first; });
+			auto id = std::optional<node_id>();
+			for (auto run = names.begin(); run != names.end();) {
+				auto const& value = *run->first;
+				auto const next = id ? ids_.next(*id) : std::nullopt;
+				id = next && values_[*next] == value ? next : ids_.find(value);
+				if (!id) {
+					throw missing_edge_node();
+				}
+				for (; run != names.end() && !(value < *run->first); ++run) {
+					auto& e = records[run->second / 2];
+					(run->second % 2 == 0 ? e.src : e.dst) = *id;
+				}
+			}
+			return records;
+		}
+
+		// adds resolved edges, grouping them by source and merging each group into its adjacency
+		auto insert_records(std::vector<edge_record> records) -> std::size_t {
+			// sort and dedupe on ids alone, then order each source's group by value, which
+			// compares node values only within a group
+			std::sort(records.begin(), records.end(), [](auto const& a, auto const& b) {
+				return std::tie(a.src, a.dst, a.weight) < std::tie(b.src, b.dst, b.weight);
+			});
+			auto const duplicate = [](auto const& a, auto const& b) { return a.src == b.src && same_edge(a, b); };
+			records.erase(std::unique(records.begin(), records.end(), duplicate), records.end());
+			// in dag mode the whole batch is checked, and the order rebuilt, in one pass
+			auto order = std::optional<std::vector<node_id>>();
+			if (dag_) {
+				order = topological_ids(records);
+				if (!order) {
+					throw std::runtime_error("Cannot call gdwg::graph<N, E>::insert_edges when the edges would create "
+					                         "a cycle in dag mode");
+				}
+			}
+
+			// merge each group into its adjacency, skipping edges already in the graph
+			auto inserted = std::size_t{0};
+			auto touched = std::vector<node_id>();
+			auto const less = [this](auto const& a, auto const& b) { return compareEdge(a, b); };
+			for (auto group = records.begin(); group != records.end();) {
+				auto const group_end =
+				    std::find_if(group, records.end(), [&](auto const& e) { return e.src != group->src; });
+				std::sort(group, group_end, less);
+				auto& es = out_.write(group->src);
+				auto const old_size = static_cast<std::ptrdiff_t>(es.size());
+				for (auto it = group; it != group_end; ++it) {
+					if (std::binary_search(es.begin(), es.begin() + old_size, *it, less)) {
+						continue;
 					}
-					return false;
+					es.push_back(*it);
+					in_.write(it->dst).push_back(it->src);
+					touched.push_back(it->dst);
 				}
-				return a->get_nodes().second < b->get_nodes().second;
+				std::inplace_merge(es.begin(), es.begin() + old_size, es.end(), less);
+				inserted += es.size() - static_cast<std::size_t>(old_size);
+				group = group_end;
+			}
+			// one sort for each reverse list that grew
+			std::sort(touched.begin(), touched.end());
+			touched.erase(std::unique(touched.begin(), touched.end()), touched.end());
+			for (auto const dst : touched) {
+				auto& in = in_.write(dst);
+				std::sort(in.begin(), in.end());
+			}
+			if (order) {
+				reset_dag(*order);
+			}
+			return inserted;
+		}
+
+		// order by dst node then weight, unweighted edge first
+		auto compareEdge(edge_record const& a, edge_record const& b) const -> bool {
+			if (a.dst == b.dst) {
+				return a.weight < b.weight;
+			}
+			return values_[a.dst] < values_[b.dst];
+		}
+
+		// orders adjacency entries against a bare destination id
+		struct dst_less {
+			graph const* g;
+			auto operator()(edge_record const& e, node_id dst) const -> bool {
+				return e.dst != dst && g->values_[e.dst] < g->values_[dst];
+			}
+			auto operator()(node_id dst, edge_record const& e) const -> bool {
+				return e.dst != dst && g->values_[dst] < g->values_[e.dst];
+			}
+		};
+
+		// binary search for the slot, so the adjacency stays sorted without a re-sort
+		auto insert_record(edge_record const& record) -> bool {
+			auto const& edges = out_[record.src];
+			auto const pos = std::lower_bound(edges.begin(), edges.end(), record, [this](auto const& a, auto const& b) {
+				return compareEdge(a, b);
+			});
+			// check no two edge are same
+			if (pos != edges.end() && same_edge(*pos, record)) {
+				return false;
+			}
+			auto const offset = pos - edges.begin();
+			auto& es = out_.write(record.src);
+			es.insert(es.begin() + offset, record);
+			auto& in = in_.write(record.dst);
+			in.insert(std::upper_bound(in.begin(), in.end(), record.src), record.src);
+			return true;
+		}
+
+		auto erase_source(node_id dst, node_id src) -> void {
+			auto& in = in_.write(dst);
+			in.erase(std::lower_bound(in.begin(), in.end(), src));
+		}
+
+		// call f once for each distinct node with an edge into dst
+		template<typename F>
+		auto for_each_source(node_id dst, F f) const -> void {
+			auto const& in = in_[dst];
+			for (auto it = in.begin(); it != in.end(); it = std::upper_bound(it, in.end(), *it)) {
+				f(*it);
+			}
+		}
+
+		// run of edges to dst inside a sorted adjacency
+		template<typename Edges>
+		auto dst_range(Edges& es, node_id dst) const {
+			return std::equal_range(es.begin(), es.end(), dst, dst_less{this});
+		}
+
+		// exact edge inside a sorted adjacency, or es.end()
+		template<typename Edges>
+		auto find_record(Edges& es, edge_record const& record) const {
+			auto const pos = std::lower_bound(es.begin(), es.end(), record, [this](auto const& a, auto const& b) {
+				return compareEdge(a, b);
+			});
+			return pos != es.end() && same_edge(*pos, record) ? pos : es.end();
+		}
+
+		static auto same_edge(edge_record const& a, edge_record const& b) -> bool {
+			return a.dst == b.dst && a.weight == b.weight;
+		}
+
+		auto view(edge_record const& e) const -> edge_view<N, E> {
+			return edge_view<N, E>{values_[e.src], values_[e.dst], e.weight};
+		}
+
+		static auto make_edge(edge_view<N, E> const& e) -> std::unique_ptr<edge> {
+			if (e.weight) {
+				return std::make_unique<weighted_edge<N, E>>(e.from, e.to, *e.weight);
 			}
-			return a->get_nodes().first < b->get_nodes().first;
+			return std::make_unique<unweighted_edge<N, E>>(e.from, e.to);
 		}
 	};
 
@@ -674,8 +1800,8 @@ namespace gdwg {
 	//********    Iterator  Class    ********//
 	///////////////////////////////////////////
 
-	template<typename N, typename E>
-	class graph<N, E>::iterator {
+	template<typename N, typename E, typename Index>
+	class graph<N, E, Index>::iterator {
 	 public:
 		using value_type = struct {
 			N from;
@@ -692,28 +1818,15 @@ namespace gdwg {
 
 		// Iterator source
 		auto operator*() -> reference {
-			return value_type{(*edge_it)->get_nodes().first, (*edge_it)->get_nodes().second, (*edge_it)->get_weight()};
+			auto const& e = graph_->out_[node_][edge_idx];
+			return value_type{graph_->values_[node_], graph_->values_[e.dst], e.weight};
 		}
 
 		// Iterator traversal
 		auto operator++() -> iterator& {
-			edge_it++;
-			// get edges
-			const auto& e_it = graph_->connect_.find(*node_it);
-			if (edge_it == e_it->second.end()) {
-				// get next element throw iterate list
-				while (true) {
-					node_it++;
-					if (node_it == graph_->nodes_.end()) {
-						*this = graph_->end();
-						break;
-					}
-					const auto& e_i = graph_->connect_.find(*node_it);
-					if (e_i != graph_->connect_.end()) {
-						edge_it = e_i->second.begin();
-						break;
-					}
-				}
+			++edge_idx;
+			if (edge_idx == graph_->out_[node_].size()) {
+				next_node();
 			}
 			return *this;
 		}
@@ -725,12 +1838,21 @@ namespace gdwg {
 		}
 
 		auto operator--() -> iterator& {
-			if (edge_it == graph_->edges_.begin()) {
-				*this = graph_->begin();
+			if (node_ != no_node && edge_idx > 0) {
+				--edge_idx;
+				return *this;
 			}
-			else {
-				edge_it--;
-				node_it = graph_->nodes_.find((*edge_it)->get_nodes().first);
+			// step back to the last edge of the previous node with edges
+			auto const& ids = graph_->ids_;
+			auto id = node_ == no_node ? ids.last() : ids.prev(node_);
+			while (id) {
+				auto const& es = graph_->out_[*id];
+				if (!es.empty()) {
+					node_ = *id;
+					edge_idx = es.size() - 1;
+					break;
+				}
+				id = ids.prev(*id);
 			}
 			return *this;
 		}
@@ -743,21 +1865,345 @@ namespace gdwg {
 
 		// Iterator comparison
 		auto operator==(iterator const& other) const -> bool {
-			return graph_ == other.graph_ && node_it == other.node_it && edge_it == other.edge_it;
+			return graph_ == other.graph_ && node_ == other.node_ && edge_idx == other.edge_idx;
 		}
 
 	 private:
-		explicit iterator(const graph<N, E>* graph_i,
-		                  typename std::set<N>::const_iterator node_i,
-		                  typename std::vector<std::shared_ptr<gdwg::edge<N, E>>>::const_iterator edge_i)
+		explicit iterator(const graph<N, E, Index>* graph_i, node_id node_i, std::size_t edge_i)
 		: graph_(graph_i)
-		, node_it(node_i)
-		, edge_it(edge_i) {}
-		friend class graph<N, E>;
-		const graph<N, E>* graph_;
-		typename std::set<N>::const_iterator node_it;
-		typename std::vector<std::shared_ptr<gdwg::edge<N, E>>>::const_iterator edge_it;
+		, node_(node_i)
+		, edge_idx(edge_i) {}
+
+		// get next element throw node list
+		auto next_node() -> void {
+			edge_idx = 0;
+			auto const& ids = graph_->ids_;
+			auto id = ids.next(node_);
+			while (id && graph_->out_[*id].empty()) {
+				id = ids.next(*id);
+			}
+			node_ = id.value_or(no_node);
+		}
+
+		friend class graph<N, E, Index>;
+		const graph<N, E, Index>* graph_ = nullptr;
+		node_id node_ = no_node;
+		std::size_t edge_idx = 0;
+	};
+
+	///////////////////////////////////////////
+	//********    CSR Graph Class    ********//
+	///////////////////////////////////////////
+
+	// Immutable compressed sparse row snapshot of a graph. Nodes are given dense ids in
+	// sorted order, so every adjacency run is already ordered by (dst, weight) and the
+	// queries below are binary searches and linear walks over contiguous arrays.
+	template<typename N, typename E>
+	class csr_graph {
+	 public:
+		class iterator;
+		using edge = gdwg::edge<N, E>;
+
+		////////  Constructor  ////////
+		csr_graph() = default;
+
+		// same as g.freeze()
+		template<typename Index>
+		explicit csr_graph(graph<N, E, Index> const& g)
+		: csr_graph(g.freeze()) {}
+
+		/////////////////////////////
+		////////  Accessors  ////////
+		/////////////////////////////
+
+		[[nodiscard]] auto is_node(N const& value) const -> bool {
+			return std::binary_search(nodes_.begin(), nodes_.end(), value);
+		}
+
+		[[nodiscard]] auto empty() const -> bool {
+			return nodes_.empty();
+		}
+
+		[[nodiscard]] auto is_connected(N const& src, N const& dst) const -> bool {
+			auto const s = index_of(src);
+			auto const d = index_of(dst);
+			if (!s || !d) {
+				throw std::runtime_error("Cannot call gdwg::csr_graph<N, E>::is_connected if src or dst node don't "
+				                         "exist in the graph");
+			}
+			auto const targets = out_targets(*s);
+			return std::binary_search(targets.begin(), targets.end(), *d);
+		}
+
+		[[nodiscard]] auto nodes() const -> std::vector<N> {
+			return nodes_;
+		}
+
+		[[nodiscard]] auto edges(N const& src, N const& dst) const -> std::vector<std::unique_ptr<edge>> {
+			auto const s = index_of(src);
+			auto const d = index_of(dst);
+			if (!s || !d) {
+				throw std::runtime_error("Cannot call gdwg::csr_graph<N, E>::edges if src or dst node don't exist in "
+				                         "the graph");
+			}
+			// run is already sorted unweighted first, then by weight
+			auto const [first, last] = run(*s, *d);
+			std::vector<std::unique_ptr<edge>> result;
+			for (auto e = first; e < last; ++e) {
+				if (weights_[e]) {
+					result.push_back(std::make_unique<weighted_edge<N, E>>(src, dst, *weights_[e]));
+				}
+				else {
+					result.push_back(std::make_unique<unweighted_edge<N, E>>(src, dst));
+				}
+			}
+			return result;
+		}
+
+		[[nodiscard]] auto find(N const& src, N const& dst, std::optional<E> weight = std::nullopt) const -> iterator {
+			auto const s = index_of(src);
+			auto const d = index_of(dst);
+			if (!s || !d) {
+				return end();
+			}
+			auto const [first, last] = run(*s, *d);
+			auto const it = std::lower_bound(weights_.begin() + static_cast<std::ptrdiff_t>(first),
+			                                 weights_.begin() + static_cast<std::ptrdiff_t>(last),
+			                                 weight);
+			if (it == weights_.begin() + static_cast<std::ptrdiff_t>(last) || *it != weight) {
+				return end();
+			}
+			return iterator(this, *s, static_cast<std::size_t>(it - weights_.begin()));
+		}
+
+		[[nodiscard]] auto connections(N const& src) const -> std::vector<N> {
+			auto const s = index_of(src);
+			if (!s) {
+				throw std::runtime_error("Cannot call gdwg::csr_graph<N, E>::connections if src doesn't exist in the "
+				                         "graph");
+			}
+			// both runs are sorted by id, and id order is node order
+			auto const out = out_targets(*s);
+			auto const in = in_sources(*s);
+			std::vector<node_id> ids;
+			std::set_union(out.begin(), out.end(), in.begin(), in.end(), std::back_inserter(ids));
+			ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+			std::vector<N> connected_nodes;
+			connected_nodes.reserve(ids.size());
+			for (auto const id : ids) {
+				connected_nodes.push_back(nodes_[id]);
+			}
+			return connected_nodes;
+		}
+
+		//////////////////////////////
+		////  Dense Index Access  ////
+		//////////////////////////////
+
+		[[nodiscard]] auto node_count() const -> std::size_t {
+			return nodes_.size();
+		}
+
+		[[nodiscard]] auto edge_count() const -> std::size_t {
+			return targets_.size();
+		}
+
+		[[nodiscard]] auto index_of(N const& value) const -> std::optional<node_id> {
+			auto const it = std::lower_bound(nodes_.begin(), nodes_.end(), value);
+			if (it == nodes_.end() || *it != value) {
+				return std::nullopt;
+			}
+			return static_cast<node_id>(it - nodes_.begin());
+		}
+
+		[[nodiscard]] auto node_at(node_id id) const -> N const& {
+			return nodes_[id];
+		}
+
+		[[nodiscard]] auto out_targets(node_id id) const -> std::span<node_id const> {
+			return {targets_.data() + offsets_[id], offsets_[id + 1] - offsets_[id]};
+		}
+
+		[[nodiscard]] auto out_weights(node_id id) const -> std::span<std::optional<E> const> {
+			return {weights_.data() + offsets_[id], offsets_[id + 1] - offsets_[id]};
+		}
+
+		[[nodiscard]] auto in_sources(node_id id) const -> std::span<node_id const> {
+			return {sources_.data() + in_offsets_[id], in_offsets_[id + 1] - in_offsets_[id]};
+		}
+
+		[[nodiscard]] auto in_weights(node_id id) const -> std::span<std::optional<E> const> {
+			return {in_weights_.data() + in_offsets_[id], in_offsets_[id + 1] - in_offsets_[id]};
+		}
+
+		/////////////////////////
+		//// Iterator Access ////
+		/////////////////////////
+
+		[[nodiscard]] auto begin() const -> iterator {
+			auto src = std::size_t{0};
+			while (src < nodes_.size() && offsets_[src + 1] == 0) {
+				++src;
+			}
+			return iterator(this, src, 0);
+		}
+
+		[[nodiscard]] auto end() const -> iterator {
+			return iterator(this, nodes_.size(), targets_.size());
+		}
+
+		////////////////////
+		//// Comparison ////
+		////////////////////
+
+		[[nodiscard]] auto operator==(csr_graph const& other) const -> bool {
+			return nodes_ == other.nodes_ && offsets_ == other.offsets_ && targets_ == other.targets_
+			       && weights_ == other.weights_;
+		}
+
+	 private:
+		template<typename, typename, typename>
+		friend class graph;
+
+		// sorted node values, position is the node id
+		std::vector<N> nodes_;
+		// outgoing edges of node n live in [offsets_[n], offsets_[n + 1])
+		std::vector<std::size_t> offsets_;
+		std::vector<node_id> targets_;
+		std::vector<std::optional<E>> weights_;
+		// incoming edges, same layout keyed by destination
+		std::vector<std::size_t> in_offsets_;
+		std::vector<node_id> sources_;
+		std::vector<std::optional<E>> in_weights_;
+
+		// fill the incoming arrays from the outgoing ones. Sources come out ascending
+		// because forward edges are walked in order.
+		auto transpose() -> void {
+			in_offsets_.assign(nodes_.size() + 1, 0);
+			for (auto const dst : targets_) {
+				++in_offsets_[dst + 1];
+			}
+			std::partial_sum(in_offsets_.begin(), in_offsets_.end(), in_offsets_.begin());
+			auto fill = std::vector<std::size_t>(in_offsets_.begin(), in_offsets_.end() - 1);
+			sources_.resize(targets_.size());
+			in_weights_.resize(targets_.size());
+			for (auto n = std::size_t{0}; n < nodes_.size(); ++n) {
+				for (auto e = offsets_[n]; e < offsets_[n + 1]; ++e) {
+					auto const pos = fill[targets_[e]]++;
+					sources_[pos] = static_cast<node_id>(n);
+					in_weights_[pos] = weights_[e];
+				}
+			}
+		}
+
+		// edge index range of all src -> dst edges
+		auto run(node_id src, node_id dst) const -> std::pair<std::size_t, std::size_t> {
+			auto const targets = out_targets(src);
+			auto const [first, last] = std::equal_range(targets.begin(), targets.end(), dst);
+			return {offsets_[src] + static_cast<std::size_t>(first - targets.begin()),
+			        offsets_[src] + static_cast<std::size_t>(last - targets.begin())};
+		}
+	};
+
+	///////////////////////////////////////////
+	//******    CSR Iterator  Class    ******//
+	///////////////////////////////////////////
+
+	template<typename N, typename E>
+	class csr_graph<N, E>::iterator {
+	 public:
+		using value_type = struct {
+			N from;
+			N to;
+			std::optional<E> weight;
+		};
+		using reference = value_type;
+		using pointer = void;
+		using difference_type = std::ptrdiff_t;
+		using iterator_category = std::bidirectional_iterator_tag;
+
+		// Iterator constructor
+		iterator() = default;
+
+		// Iterator source
+		auto operator*() const -> reference {
+			return value_type{graph_->nodes_[src_], graph_->nodes_[graph_->targets_[edge_]], graph_->weights_[edge_]};
+		}
+
+		// Iterator traversal, src_ always names the run that contains edge_
+		auto operator++() -> iterator& {
+			++edge_;
+			while (src_ < graph_->nodes_.size() && graph_->offsets_[src_ + 1] <= edge_) {
+				++src_;
+			}
+			return *this;
+		}
+
+		auto operator++(int) -> iterator {
+			auto temp = *this;
+			++*this;
+			return temp;
+		}
+
+		auto operator--() -> iterator& {
+			--edge_;
+			while (graph_->offsets_[src_] > edge_) {
+				--src_;
+			}
+			return *this;
+		}
+
+		auto operator--(int) -> iterator {
+			auto temp = *this;
+			--*this;
+			return temp;
+		}
+
+		// Iterator comparison
+		auto operator==(iterator const& other) const -> bool {
+			return graph_ == other.graph_ && edge_ == other.edge_;
+		}
+
+	 private:
+		explicit iterator(const csr_graph<N, E>* graph_i, std::size_t src_i, std::size_t edge_i)
+		: graph_(graph_i)
+		, src_(src_i)
+		, edge_(edge_i) {}
+		friend class csr_graph<N, E>;
+		const csr_graph<N, E>* graph_ = nullptr;
+		std::size_t src_ = 0;
+		std::size_t edge_ = 0;
 	};
+
+	// Nodes get csr ids in one walk in node order. Edges are then translated through
+	// an array from graph id to csr id, so no node values are compared. Adjacency
+	// lists are sorted by (dst, weight), which is already csr order.
+	template<typename N, typename E, typename Index>
+	auto graph<N, E, Index>::freeze() const -> csr_graph<N, E> {
+		auto csr = csr_graph<N, E>();
+		auto const ids = sorted_ids();
+		auto to_csr = std::vector<node_id>(values_.size());
+		auto edge_count = std::size_t{0};
+		csr.nodes_.reserve(ids.size());
+		for (auto i = std::size_t{0}; i < ids.size(); ++i) {
+			to_csr[ids[i]] = static_cast<node_id>(i);
+			csr.nodes_.push_back(values_[ids[i]]);
+			edge_count += out_[ids[i]].size();
+		}
+		csr.offsets_.reserve(ids.size() + 1);
+		csr.offsets_.push_back(0);
+		csr.targets_.reserve(edge_count);
+		csr.weights_.reserve(edge_count);
+		for (auto const id : ids) {
+			for (auto const& e : out_[id]) {
+				csr.targets_.push_back(to_csr[e.dst]);
+				csr.weights_.push_back(e.weight);
+			}
+			csr.offsets_.push_back(csr.targets_.size());
+		}
+		csr.transpose();
+		return csr;
+	}
 } // namespace gdwg
 
 #endif // GDWG_GRAPH_H
@@ -2,6 +2,9 @@
 
 #include <catch2/catch.hpp>
 
+#include <cmath>
+#include <random>
+
 using namespace gdwg;
 
 TEST_CASE("Test Graph Constructors: Initialize") {
@@ -37,6 +40,68 @@ TEST_CASE("Test Graph Constructors: Copy") {
 	REQUIRE(g2.connections("a") == std::vector<std::string>{"b"});
 }
 
+TEST_CASE("Test Graph Constructors: Copy Owns Its Nodes") {
+	auto g1 = gdwg::graph<std::string, int>{"a", "b", "c"};
+	g1.insert_edge("a", "c", 1);
+	auto g2 = gdwg::graph<std::string, int>{};
+	g2 = g1;
+	g1.replace_node("a", "z");
+	g1.erase_node("b");
+	REQUIRE(g2.nodes() == std::vector<std::string>{"a", "b", "c"});
+	REQUIRE(g2.is_connected("a", "c"));
+	auto g3 = std::move(g2);
+	REQUIRE(g3.is_node("b"));
+	REQUIRE((*g3.begin()).from == "a");
+}
+
+TEST_CASE("Test Graph Constructors: Copies Share Until Written") {
+	// enough nodes for two levels of storage branches, padded so names sort by number
+	auto name = [](int i) {
+		auto s = std::to_string(i);
+		return std::string(4 - s.size(), '0') + s;
+	};
+	auto g1 = gdwg::graph<std::string, int>{};
+	for (auto i = 0; i < 5000; ++i) {
+		g1.insert_node(name(i));
+	}
+	for (auto i = 0; i < 4999; ++i) {
+		g1.insert_edge(name(i), name(i + 1), i);
+	}
+	auto const before = g1;
+	auto g2 = g1;
+
+	SECTION("Edge writes stay in one copy") {
+		REQUIRE(g2.insert_edge(name(150), name(3), 7));
+		REQUIRE(g2.erase_edge(name(10), name(11), 10));
+		REQUIRE_FALSE(g2.erase_edge(name(10), name(11), 10));
+		g2.erase_edge(g2.begin());
+		REQUIRE(g1 == before);
+		REQUIRE(g2.is_connected(name(150), name(3)));
+		REQUIRE_FALSE(g2.is_connected(name(0), name(1)));
+		REQUIRE_FALSE(g1.is_connected(name(150), name(3)));
+		g1.insert_edge(name(3), name(150));
+		REQUIRE_FALSE(g2.is_connected(name(3), name(150)));
+		REQUIRE(std::distance(g2.begin(), g2.end()) == 4998);
+	}
+	SECTION("Node writes stay in one copy") {
+		g2.erase_node(name(100));
+		g2.replace_node(name(5), name(9500));
+		g2.merge_replace_node(name(6), name(7));
+		g2.insert_node(name(9000));
+		REQUIRE(g1 == before);
+		REQUIRE(g1.is_connected(name(99), name(100)));
+		REQUIRE(g1.connections(name(6)) == std::vector<std::string>{name(5), name(7)});
+		REQUIRE(g2.connections(name(7)) == std::vector<std::string>{name(7), name(8), name(9500)});
+		REQUIRE_FALSE(g1.is_node(name(9000)));
+		REQUIRE(g2.nodes().size() == 4999);
+	}
+	SECTION("Clear leaves the copy") {
+		g1.clear();
+		REQUIRE(g1.empty());
+		REQUIRE(g2 == before);
+	}
+}
+
 TEST_CASE("Test Edge Virtual Functions") {
 	SECTION("Weighted_Edge") {
 		auto weighted_e = gdwg::weighted_edge<std::string, int>{"a", "b", 1};
@@ -79,6 +144,95 @@ TEST_CASE("Test Modifiers: Insert Edge") {
 	}
 }
 
+TEST_CASE("Test Modifiers: Insert Edge Keeps Order") {
+	auto g = gdwg::graph<std::string, int>{};
+	auto edges = std::vector<std::tuple<std::string, std::string, int>>{};
+	for (auto i = 0; i < 20; ++i) {
+		g.insert_node("n" + std::to_string(i));
+	}
+	for (auto i = 0; i < 20; ++i) {
+		for (auto j = 0; j < 20; j += 3) {
+			edges.emplace_back("n" + std::to_string(i), "n" + std::to_string(j), (i * j) % 7);
+		}
+	}
+	std::shuffle(edges.begin(), edges.end(), std::mt19937{6771});
+	for (auto const& [src, dst, weight] : edges) {
+		REQUIRE(g.insert_edge(src, dst, weight));
+		REQUIRE_FALSE(g.insert_edge(src, dst, weight));
+	}
+	std::sort(edges.begin(), edges.end());
+	auto i = std::size_t{0};
+	for (auto const& [from, to, weight] : g) {
+		REQUIRE(std::get<0>(edges[i]) == from);
+		REQUIRE(std::get<1>(edges[i]) == to);
+		REQUIRE(std::get<2>(edges[i]) == weight);
+		++i;
+	}
+	REQUIRE(i == edges.size());
+}
+
+TEST_CASE("Test Modifiers: Insert Edges") {
+	auto g = gdwg::graph<std::string, int>{"a", "b", "c"};
+	g.insert_edge("a", "b", 1);
+	auto const batch = std::vector<std::tuple<std::string, std::string, std::optional<int>>>{
+	    {"c", "a", 2},
+	    {"a", "b", 1},
+	    {"a", "b", std::nullopt},
+	    {"c", "a", 2},
+	    {"a", "c", 5},
+	};
+	REQUIRE(g.insert_edges(batch) == 3);
+	REQUIRE(g.insert_edges(batch.begin(), batch.end()) == 0);
+
+	auto expected = gdwg::graph<std::string, int>{"a", "b", "c"};
+	expected.insert_edge("a", "b", 1);
+	for (auto const& [src, dst, weight] : batch) {
+		expected.insert_edge(src, dst, weight);
+	}
+	REQUIRE(g == expected);
+	SECTION("Error Case") {
+		auto const bad = std::vector<std::tuple<std::string, std::string, int>>{{"a", "c", 9}, {"a", "d", 1}};
+		REQUIRE_THROWS_AS(g.insert_edges(bad), std::runtime_error);
+		REQUIRE(g == expected);
+	}
+	SECTION("From another graph") {
+		auto copy = gdwg::graph<std::string, int>{"a", "b", "c"};
+		REQUIRE(copy.insert_edges(g.begin(), g.end()) == 4);
+		REQUIRE(copy == g);
+	}
+}
+
+TEST_CASE("Test Modifiers: Insert Edges Resolves Every Name") {
+	auto check = [](auto g) {
+		for (auto i = 0; i < 60; ++i) {
+			g.insert_node("n" + std::to_string(i));
+		}
+		auto expected = g;
+		auto rng = std::mt19937{29};
+		auto pick = std::uniform_int_distribution<int>(0, 59);
+		auto batch = std::vector<std::tuple<std::string, std::string, int>>();
+		for (auto i = 0; i < 400; ++i) {
+			// runs of one src, as most batches come, then shuffled ones
+			auto const src = i < 200 ? i / 10 : pick(rng);
+			batch.emplace_back("n" + std::to_string(src), "n" + std::to_string(pick(rng)), pick(rng) % 3);
+		}
+		for (auto const& [src, dst, weight] : batch) {
+			expected.insert_edge(src, dst, weight);
+		}
+		auto const edges = static_cast<std::size_t>(std::distance(expected.begin(), expected.end()));
+		auto copy = g;
+		REQUIRE(g.insert_edges(batch) == edges);
+		REQUIRE(g == expected);
+		// tuples made on the fly, which cannot be pointed at
+		auto const made = std::views::iota(std::size_t{0}, batch.size())
+		                  | std::views::transform([&](std::size_t i) { return batch[i]; });
+		REQUIRE(copy.insert_edges(made) == edges);
+		REQUIRE(copy == expected);
+	};
+	check(gdwg::graph<std::string, int>{});
+	check(gdwg::graph<std::string, int, gdwg::hashed_index>{});
+}
+
 TEST_CASE("Test Modifiers: Replace Node") {
 	auto g = gdwg::graph<std::string, int>{"a", "b", "c"};
 	g.insert_edge("a", "b", 1);
@@ -118,6 +272,73 @@ TEST_CASE("Test Modifiers: Erase Node") {
 	}
 }
 
+TEST_CASE("Test Modifiers: Node Churn Keeps Edges Consistent") {
+	auto g = gdwg::graph<std::string, int>{"a", "b", "c", "d"};
+	g.insert_edge("a", "b", 1);
+	g.insert_edge("a", "b", 2);
+	g.insert_edge("b", "b");
+	g.insert_edge("c", "b", 3);
+	g.insert_edge("b", "d", 4);
+	g.insert_edge("d", "a");
+	SECTION("Erase node with incoming edges and self loop") {
+		REQUIRE(g.erase_node("b"));
+		auto expected = gdwg::graph<std::string, int>{"a", "c", "d"};
+		expected.insert_edge("d", "a");
+		REQUIRE(g == expected);
+		REQUIRE(g.connections("a") == std::vector<std::string>{"d"});
+		REQUIRE(g.connections("c").empty());
+	}
+	SECTION("Replace node moves incoming edges") {
+		REQUIRE(g.replace_node("b", "0"));
+		auto expected = gdwg::graph<std::string, int>{"a", "0", "c", "d"};
+		expected.insert_edge("a", "0", 1);
+		expected.insert_edge("a", "0", 2);
+		expected.insert_edge("0", "0");
+		expected.insert_edge("c", "0", 3);
+		expected.insert_edge("0", "d", 4);
+		expected.insert_edge("d", "a");
+		REQUIRE(g == expected);
+		REQUIRE(g.connections("0") == std::vector<std::string>{"0", "a", "c", "d"});
+		g.insert_edge("a", "c");
+		REQUIRE((*g.begin()).to == "0");
+	}
+	SECTION("Merge replace node in both directions") {
+		g.insert_edge("d", "b", 1);
+		g.merge_replace_node("b", "a");
+		auto expected = gdwg::graph<std::string, int>{"a", "c", "d"};
+		expected.insert_edge("a", "a", 1);
+		expected.insert_edge("a", "a", 2);
+		expected.insert_edge("a", "a");
+		expected.insert_edge("c", "a", 3);
+		expected.insert_edge("a", "d", 4);
+		expected.insert_edge("d", "a");
+		expected.insert_edge("d", "a", 1);
+		REQUIRE(g == expected);
+		REQUIRE(g.connections("d") == std::vector<std::string>{"a"});
+		REQUIRE(g.erase_node("a"));
+		REQUIRE(g.connections("c").empty());
+		REQUIRE(g.connections("d").empty());
+	}
+}
+
+TEST_CASE("Test Modifiers: Erased Node Ids Are Reused") {
+	auto g = gdwg::graph<std::string, int>{"a", "b", "c"};
+	g.insert_edge("a", "b", 1);
+	g.insert_edge("b", "c", 2);
+	REQUIRE(g.erase_node("b"));
+	REQUIRE(g.insert_node("x"));
+	REQUIRE(g.insert_node("b"));
+	REQUIRE_FALSE(g.is_connected("a", "b"));
+	REQUIRE(g.connections("x").empty());
+	g.insert_edge("x", "a", 3);
+	g.insert_edge("b", "x");
+	REQUIRE(g.nodes() == std::vector<std::string>{"a", "b", "c", "x"});
+	REQUIRE(g.connections("x") == std::vector<std::string>{"a", "b"});
+	auto out = std::ostringstream{};
+	out << g;
+	REQUIRE(out.str() == "a (\n)\nb (\n  b -> x | U\n)\nc (\n)\nx (\n  x -> a | W | 3\n)\n");
+}
+
 TEST_CASE("Test Modifiers: Erase Edge") {
 	auto g = gdwg::graph<std::string, int>{"a", "b", "c"};
 	g.insert_edge("a", "b", 1);
@@ -209,6 +430,25 @@ TEST_CASE("Test Accessors: Edges") {
 	REQUIRE_THROWS_AS(g.edges("e", "e"), std::runtime_error);
 }
 
+TEST_CASE("Test Accessors: Edges View") {
+	auto g = gdwg::graph<std::string, int>{"a", "b", "c"};
+	g.insert_edge("a", "b", 10);
+	g.insert_edge("a", "b");
+	g.insert_edge("a", "b", 1);
+	g.insert_edge("a", "c", 1);
+	auto weights = std::vector<std::optional<int>>{};
+	for (auto const& e : g.edges_view("a", "b")) {
+		REQUIRE(e.from == "a");
+		REQUIRE(e.to == "b");
+		weights.push_back(e.weight);
+	}
+	REQUIRE(weights == std::vector<std::optional<int>>{std::nullopt, 1, 10});
+	auto const view = g.edges_view("a", "b");
+	REQUIRE(&(*view.begin()).from == &(*g.edges_view("a", "c").begin()).from);
+	REQUIRE(std::ranges::distance(g.edges_view("b", "a")) == 0);
+	REQUIRE_THROWS_AS(g.edges_view("a", "e"), std::runtime_error);
+}
+
 TEST_CASE("Test Accessors: Find") {
 	auto g = gdwg::graph<std::string, int>{"a", "b", "c"};
 	g.insert_edge("a", "b", 1);
@@ -222,6 +462,36 @@ TEST_CASE("Test Accessors: Find") {
 	}
 }
 
+TEST_CASE("Test Accessors: Lookups On A Hub Node") {
+	auto g = gdwg::graph<std::string, int>{"hub"};
+	for (auto i = 0; i < 200; i += 2) {
+		auto const leaf = "n" + std::to_string(i);
+		g.insert_node(leaf);
+		g.insert_edge("hub", leaf, i);
+		g.insert_edge("hub", leaf, -i);
+	}
+	g.insert_node("n1");
+	g.insert_edge("hub", "n50");
+	REQUIRE(g.is_connected("hub", "n198"));
+	REQUIRE_FALSE(g.is_connected("hub", "n1"));
+	REQUIRE_FALSE(g.is_connected("n50", "hub"));
+	auto const es = g.edges("hub", "n50");
+	REQUIRE(es.size() == 3);
+	REQUIRE_FALSE(es[0]->is_weighted());
+	REQUIRE(es[1]->get_weight() == -50);
+	REQUIRE(es[2]->get_weight() == 50);
+	REQUIRE(g.edges("hub", "n1").empty());
+	auto it = g.find("hub", "n50", 50);
+	REQUIRE((*it).to == "n50");
+	++it;
+	REQUIRE((*it).to == "n52");
+	REQUIRE((*it).weight == -52);
+	REQUIRE(g.find("hub", "n50", 7) == g.end());
+	REQUIRE(g.erase_edge("hub", "n50"));
+	REQUIRE_FALSE(g.erase_edge("hub", "n50"));
+	REQUIRE(g.edges("hub", "n50").size() == 2);
+}
+
 TEST_CASE("Test Accessors: Connections") {
 	auto g = gdwg::graph<std::string, int>{"a", "b", "c"};
 	g.insert_edge("a", "b", 1);
@@ -330,6 +600,70 @@ e (
 		auto const expected_output = std::string_view(R"()");
 		REQUIRE(out.str() == expected_output);
 	}
+	SECTION("Matches print_edge") {
+		// weights across the whole double range, and past one buffer of output
+		auto g = gdwg::graph<std::string, double>{};
+		auto rng = std::mt19937{41};
+		auto pick = std::uniform_int_distribution<int>(0, 499);
+		auto mantissa = std::uniform_real_distribution<double>(-10.0, 10.0);
+		auto exponent = std::uniform_int_distribution<int>(-12, 300);
+		for (auto i = 0; i < 500; ++i) {
+			g.insert_node("node " + std::to_string(i));
+		}
+		for (auto i = 0; i < 5000; ++i) {
+			auto const src = "node " + std::to_string(pick(rng));
+			auto const dst = "node " + std::to_string(pick(rng));
+			if (i % 5 == 0) {
+				g.insert_edge(src, dst);
+			}
+			else {
+				g.insert_edge(src, dst, mantissa(rng) * std::pow(10.0, exponent(rng)));
+			}
+		}
+		g.insert_edge("node 0", "node 1", -0.0);
+		g.insert_edge("node 0", "node 1", 0.0000005);
+
+		auto expected = std::string();
+		for (auto const& node : g.nodes()) {
+			auto unweighted = std::string();
+			auto weighted = std::string();
+			for (auto it = g.begin(); it != g.end(); ++it) {
+				auto const [from, to, weight] = *it;
+				if (from == node) {
+					auto const edges = g.edges(from, to);
+					for (auto const& e : edges) {
+						if (e->get_weight() == weight) {
+							(weight ? weighted : unweighted) += "\n  " + e->print_edge();
+						}
+					}
+				}
+			}
+			expected += node + " (" + unweighted + weighted + "\n)\n";
+		}
+		auto out = std::ostringstream{};
+		out << g;
+		REQUIRE(out.str().size() > std::size_t{1} << 16);
+		REQUIRE(out.str() == expected);
+	}
+	SECTION("Nodes that are not strings") {
+		auto g = gdwg::graph<int, float>{3, 10, -2};
+		g.insert_edge(10, -2, 1.5f);
+		g.insert_edge(10, 3);
+		g.insert_edge(3, 3, -0.25f);
+		auto out = std::ostringstream{};
+		out << g;
+		auto const expected_output = std::string_view(R"(-2 (
+)
+3 (
+  3 -> 3 | W | -0.250000
+)
+10 (
+  10 -> 3 | U
+  10 -> -2 | W | 1.500000
+)
+)");
+		REQUIRE(out.str() == expected_output);
+	}
 }
 
 TEST_CASE("Test Iterator: Constructor") {
@@ -415,4 +749,272 @@ TEST_CASE("Test Iterator: Comparison") {
 	auto it3 = g.begin();
 	REQUIRE(it1 == it3);
 	REQUIRE_FALSE(it1 == it2);
-}
\ No newline at end of file
+}
+
+TEST_CASE("Test CSR Graph: Freeze") {
+	auto g = gdwg::graph<std::string, int>{"a", "b", "c", "d"};
+	g.insert_edge("a", "b", 10);
+	g.insert_edge("a", "b", 1);
+	g.insert_edge("a", "b");
+	g.insert_edge("c", "a", 3);
+	g.insert_edge("c", "c");
+	auto const csr = g.freeze();
+	REQUIRE(csr.nodes() == g.nodes());
+	REQUIRE(csr.node_count() == 4);
+	REQUIRE(csr.edge_count() == 5);
+	REQUIRE(csr.is_node("d"));
+	REQUIRE_FALSE(csr.is_node("e"));
+	SECTION("Iteration matches graph") {
+		auto it = g.begin();
+		for (auto const& [from, to, weight] : csr) {
+			REQUIRE(it != g.end());
+			REQUIRE((*it).from == from);
+			REQUIRE((*it).to == to);
+			REQUIRE((*it).weight == weight);
+			++it;
+		}
+		REQUIRE(it == g.end());
+		auto back = csr.end();
+		--back;
+		REQUIRE((*back).from == "c");
+		REQUIRE((*back).to == "c");
+	}
+	SECTION("Queries") {
+		REQUIRE(csr.is_connected("a", "b"));
+		REQUIRE_FALSE(csr.is_connected("b", "a"));
+		REQUIRE_THROWS_AS(csr.is_connected("e", "a"), std::runtime_error);
+		auto const es = csr.edges("a", "b");
+		REQUIRE(es.size() == 3);
+		REQUIRE_FALSE(es[0]->is_weighted());
+		REQUIRE(es[1]->get_weight() == 1);
+		REQUIRE(es[2]->get_weight() == 10);
+		REQUIRE(csr.connections("a") == std::vector<std::string>{"b", "c"});
+		REQUIRE(csr.connections("d").empty());
+	}
+	SECTION("Find") {
+		auto it = csr.find("a", "b", 10);
+		REQUIRE((*it).weight == 10);
+		++it;
+		REQUIRE((*it).from == "c");
+		REQUIRE((*it).to == "a");
+		REQUIRE(csr.find("a", "b", 5) == csr.end());
+		REQUIRE(csr.find("a", "e") == csr.end());
+	}
+	SECTION("Snapshot is independent") {
+		g.insert_edge("d", "a");
+		REQUIRE_FALSE(csr.is_connected("d", "a"));
+		REQUIRE(csr.in_sources(*csr.index_of("a")).size() == 1);
+	}
+	SECTION("Erased edges leave no empty runs") {
+		g.erase_edge("c", "a", 3);
+		g.erase_edge("c", "c");
+		auto const frozen = g.freeze();
+		REQUIRE(frozen.edge_count() == 3);
+		REQUIRE(frozen.connections("c").empty());
+	}
+}
+
+TEST_CASE("Test Value Edge Storage") {
+	auto g1 = gdwg::graph<std::string, int>{"a", "b", "c"};
+	g1.insert_edge("a", "b", 1);
+	g1.insert_edge("b", "a");
+	SECTION("Copies do not share edges") {
+		auto g2 = g1;
+		g2.replace_node("a", "z");
+		REQUIRE(g1.is_connected("a", "b"));
+		REQUIRE(g2.is_connected("z", "b"));
+		REQUIRE(g1.edges("b", "a").size() == 1);
+		REQUIRE_FALSE(g1 == g2);
+	}
+	SECTION("Replace node keeps adjacency ordered") {
+		g1.insert_edge("b", "c", 2);
+		g1.replace_node("a", "d");
+		auto it = g1.find("b", "c", 2);
+		++it;
+		REQUIRE((*it).from == "b");
+		REQUIRE((*it).to == "d");
+	}
+	SECTION("Erase unweighted edge by iterator") {
+		auto it = g1.find("b", "a");
+		REQUIRE(g1.erase_edge(it) == g1.end());
+		REQUIRE_FALSE(g1.is_connected("b", "a"));
+	}
+}
+
+TEST_CASE("Test Node Index: Hashed Matches Ordered") {
+	auto ordered = gdwg::graph<std::string, int>{};
+	auto hashed = gdwg::graph<std::string, int, gdwg::hashed_index>{};
+	auto rng = std::mt19937{6771};
+	for (auto step = 0; step < 3000; ++step) {
+		auto const a = "n" + std::to_string(rng() % 80);
+		auto const b = "n" + std::to_string(rng() % 80);
+		auto const weight = static_cast<int>(rng() % 3);
+		switch (rng() % 6) {
+		case 0:
+		case 1: REQUIRE(ordered.insert_node(a) == hashed.insert_node(a)); break;
+		case 2: REQUIRE(ordered.erase_node(a) == hashed.erase_node(a)); break;
+		case 3:
+			if (ordered.is_node(a)) {
+				REQUIRE(ordered.replace_node(a, b) == hashed.replace_node(a, b));
+			}
+			break;
+		default:
+			if (ordered.is_node(a) && ordered.is_node(b)) {
+				REQUIRE(ordered.insert_edge(a, b, weight) == hashed.insert_edge(a, b, weight));
+			}
+		}
+		REQUIRE(ordered.is_node(a) == hashed.is_node(a));
+		REQUIRE(ordered.is_node(b) == hashed.is_node(b));
+	}
+	REQUIRE(ordered.nodes() == hashed.nodes());
+	auto ordered_out = std::ostringstream{};
+	auto hashed_out = std::ostringstream{};
+	ordered_out << ordered;
+	hashed_out << hashed;
+	REQUIRE(ordered_out.str() == hashed_out.str());
+
+	auto copy = hashed;
+	REQUIRE(copy == hashed);
+	auto it = copy.end();
+	for (auto const& [from, to, weight] : ordered) {
+		REQUIRE(hashed.find(from, to, weight) != hashed.end());
+	}
+	for (auto i = std::size_t{0}; i < 5 && it != copy.begin(); ++i) {
+		--it;
+	}
+	REQUIRE(it != copy.end());
+}
+
+TEST_CASE("Test Node Index: Copies Keep Their Nodes") {
+	// every snapshot taken during random node churn must still list exactly the nodes
+	// it had, in order both ways, whatever its copies did afterwards
+	auto check = [](auto g) {
+		auto rng = std::mt19937{6771};
+		auto model = std::set<int>();
+		auto snapshots = std::vector<std::pair<decltype(g), std::set<int>>>();
+		for (auto step = 0; step < 6000; ++step) {
+			auto const a = static_cast<int>(rng() % 3000);
+			if (rng() % 3 == 0) {
+				REQUIRE(g.erase_node(a) == (model.erase(a) == 1));
+			}
+			else if (rng() % 5 == 0 && model.contains(a)) {
+				auto const b = a + 3000;
+				REQUIRE(g.replace_node(a, b) == !model.contains(b));
+				if (!model.contains(b)) {
+					model.erase(a);
+					model.insert(b);
+				}
+			}
+			else {
+				REQUIRE(g.insert_node(a) == model.insert(a).second);
+			}
+			if (step % 500 == 0) {
+				snapshots.emplace_back(g, model);
+			}
+		}
+		for (auto& [snapshot, nodes] : snapshots) {
+			REQUIRE(snapshot.nodes() == std::vector<int>(nodes.begin(), nodes.end()));
+			for (auto const n : nodes) {
+				REQUIRE(snapshot.is_node(n));
+				snapshot.insert_edge(n, *nodes.begin(), 1);
+			}
+			auto backward = std::vector<int>();
+			for (auto it = snapshot.end(); it != snapshot.begin();) {
+				backward.push_back((*--it).from);
+			}
+			REQUIRE(std::equal(backward.rbegin(), backward.rend(), nodes.begin(), nodes.end()));
+		}
+		REQUIRE(g.nodes() == std::vector<int>(model.begin(), model.end()));
+	};
+	check(gdwg::graph<int, int>{});
+	check(gdwg::graph<int, int, gdwg::hashed_index>{});
+}
+
+TEST_CASE("Test Topological Order") {
+	auto g = gdwg::graph<std::string, int>{"a", "b", "c", "d", "e"};
+	g.insert_edge("d", "b", 1);
+	g.insert_edge("b", "a");
+	g.insert_edge("c", "a", 2);
+	g.insert_edge("c", "a", 3);
+	REQUIRE(g.topological_order() == std::vector<std::string>{"c", "d", "e", "b", "a"});
+	g.insert_edge("a", "d", 1);
+	REQUIRE_THROWS_AS(g.topological_order(), std::runtime_error);
+	REQUIRE_THROWS_AS(g.set_dag_mode(true), std::runtime_error);
+	REQUIRE_FALSE(g.dag_mode());
+}
+
+TEST_CASE("Test Modifiers: Dag Mode") {
+	auto g = gdwg::graph<std::string, int>{"a", "b", "c", "d"};
+	g.set_dag_mode(true);
+	REQUIRE(g.dag_mode());
+	g.insert_edge("c", "b", 1);
+	g.insert_edge("b", "a", 1);
+	g.insert_edge("d", "c");
+	auto const before = g;
+	REQUIRE_THROWS_AS(g.insert_edge("a", "d", 1), std::runtime_error);
+	REQUIRE_THROWS_AS(g.insert_edge("a", "a"), std::runtime_error);
+	REQUIRE_THROWS_AS(g.insert_edges(std::vector<std::tuple<std::string, std::string, int>>{{"a", "b", 2}}),
+	                  std::runtime_error);
+	REQUIRE_THROWS_AS(g.merge_replace_node("a", "d"), std::runtime_error);
+	REQUIRE(g == before);
+	REQUIRE(g.topological_order() == std::vector<std::string>{"d", "c", "b", "a"});
+
+	SECTION("Order follows inserts, merges and copies") {
+		g.insert_node("e");
+		g.insert_edge("e", "d", 1);
+		g.insert_edge("b", "a", 2);
+		REQUIRE(g.topological_order() == std::vector<std::string>{"e", "d", "c", "b", "a"});
+		auto copy = g;
+		copy.erase_node("c");
+		copy.insert_edge("a", "d");
+		REQUIRE(copy.topological_order() == std::vector<std::string>{"e", "b", "a", "d"});
+		REQUIRE(g.topological_order() == std::vector<std::string>{"e", "d", "c", "b", "a"});
+		g.insert_node("f");
+		g.insert_edge("f", "a");
+		g.insert_edge("d", "f");
+		g.merge_replace_node("f", "c");
+		REQUIRE(g.connections("c") == std::vector<std::string>{"a", "b", "d"});
+		REQUIRE(g.topological_order() == std::vector<std::string>{"e", "d", "c", "b", "a"});
+		g.set_dag_mode(false);
+		g.insert_edge("a", "e");
+		REQUIRE_THROWS_AS(g.topological_order(), std::runtime_error);
+	}
+	SECTION("Random inserts match reachability") {
+		auto dag = gdwg::graph<int, int>{};
+		dag.set_dag_mode(true);
+		auto const n = 60;
+		for (auto i = 0; i < n; ++i) {
+			dag.insert_node(i);
+		}
+		auto reach = std::vector<std::vector<bool>>(n, std::vector<bool>(n));
+		auto rng = std::mt19937{17};
+		auto pick = std::uniform_int_distribution<int>(0, n - 1);
+		for (auto i = 0; i < 600; ++i) {
+			auto const a = pick(rng);
+			auto const b = pick(rng);
+			auto const ua = static_cast<std::size_t>(a);
+			auto const ub = static_cast<std::size_t>(b);
+			if (a == b || reach[ub][ua]) {
+				REQUIRE_THROWS_AS(dag.insert_edge(a, b), std::runtime_error);
+				continue;
+			}
+			dag.insert_edge(a, b);
+			// everything reaching a now reaches everything b reaches
+			for (auto x = std::size_t{0}; x < n; ++x) {
+				if (x == ua || reach[x][ua]) {
+					for (auto y = std::size_t{0}; y < n; ++y) {
+						reach[x][y] = reach[x][y] || y == ub || reach[ub][y];
+					}
+				}
+			}
+		}
+		auto position = std::vector<std::size_t>(n);
+		auto const order = dag.topological_order();
+		for (auto i = std::size_t{0}; i < order.size(); ++i) {
+			position[static_cast<std::size_t>(order[i])] = i;
+		}
+		for (auto const& [from, to, weight] : dag) {
+			REQUIRE(position[static_cast<std::size_t>(from)] < position[static_cast<std::size_t>(to)]);
+		}
+	}
+}
@@ -0,0 +1,3 @@
+#include "gdwg_graph_io.h"
+
+using namespace gdwg;
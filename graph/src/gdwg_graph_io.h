@@ -0,0 +1,788 @@
+#ifndef GDWG_GRAPH_IO_H
+#define GDWG_GRAPH_IO_H
+
+#include "gdwg_graph.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <istream>
+#include <iterator>
+#include <limits>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Reading and writing graphs. The binary format is the csr_graph layout written out
+// section by section, so a mapped file can be queried in place without parsing. The
+// text formats are read back in chunks into one batch of edges.
+
+namespace gdwg {
+	namespace detail {
+		// Binary file layout, native byte order, every section starting 8 byte aligned:
+		//   header
+		//   name offsets   u64[nodes + 1]   node i is names[offset i, offset i + 1)
+		//   names          bytes            in sorted order, so ids match csr_graph
+		//   out offsets    u64[nodes + 1]
+		//   targets        u32[edges]       each run sorted by (dst, weight)
+		//   weighted       u8[edges]        0 for an unweighted edge
+		//   weights        E[edges]         E{} for an unweighted edge
+		//   in offsets     u64[nodes + 1]
+		//   sources        u32[edges]
+		inline constexpr auto file_magic = std::array<char, 8>{'G', 'D', 'W', 'G', 'C', 'S', 'R', '\0'};
+		inline constexpr auto file_version = std::uint32_t{1};
+		inline constexpr auto file_sections = std::size_t{8};
+
+		struct file_header {
+			std::array<char, 8> magic;
+			std::uint32_t version;
+			// 0x01020304 as written, so a file from another byte order is refused
+			std::uint32_t byte_order;
+			std::uint32_t weight_size;
+			// 0 unsigned, 1 signed, 2 floating point
+			std::uint32_t weight_kind;
+			std::uint64_t node_count;
+			std::uint64_t edge_count;
+			std::uint64_t name_bytes;
+			std::array<std::uint64_t, file_sections> checksums;
+			// of every field above
+			std::uint64_t header_checksum;
+		};
+
+		// Weights are read in place from 8 byte aligned sections, so they can't need more
+		// alignment than that. Excludes long double, whose 16 bytes also hold padding
+		// that would be written out uninitialised.
+		template<typename E>
+		inline constexpr bool is_file_weight_v = std::is_arithmetic_v<E> && alignof(E) <= 8 && sizeof(E) <= 8;
+
+		template<typename E>
+		constexpr auto weight_kind() -> std::uint32_t {
+			return std::is_floating_point_v<E> ? 2u : std::is_signed_v<E> ? 1u : 0u;
+		}
+
+		// 64 bit checksum a word at a time, fast enough to check a file as it loads
+		inline auto checksum(std::span<std::byte const> bytes) -> std::uint64_t {
+			auto h = 0x9e3779b97f4a7c15ull ^ bytes.size();
+			auto mix = [&](std::uint64_t word) {
+				h = std::rotl(h ^ (word * 0x87c37b91114253d5ull), 31) * 0x4cf5ad432745937full;
+			};
+			auto i = std::size_t{0};
+			for (; i + 8 <= bytes.size(); i += 8) {
+				auto word = std::uint64_t{0};
+				std::memcpy(&word, bytes.data() + i, 8);
+				mix(word);
+			}
+			if (i < bytes.size()) {
+				auto word = std::uint64_t{0};
+				std::memcpy(&word, bytes.data() + i, bytes.size() - i);
+				mix(word);
+			}
+			h ^= h >> 33;
+			h *= 0xff51afd7ed558ccdull;
+			return h ^ (h >> 33);
+		}
+
+		inline auto header_checksum(file_header const& header) -> std::uint64_t {
+			return checksum(std::as_bytes(std::span(&header, 1)).first(offsetof(file_header, header_checksum)));
+		}
+
+		inline auto padded(std::uint64_t bytes) -> std::uint64_t {
+			return (bytes + 7) / 8 * 8;
+		}
+
+		// byte size of every section, in file order
+		inline auto section_sizes(file_header const& header) -> std::array<std::uint64_t, file_sections> {
+			auto const offsets = (header.node_count + 1) * sizeof(std::uint64_t);
+			auto const ids = header.edge_count * sizeof(node_id);
+			return {offsets,
+			        header.name_bytes,
+			        offsets,
+			        ids,
+			        header.edge_count,
+			        header.edge_count * header.weight_size,
+			        offsets,
+			        ids};
+		}
+
+		// a whole file mapped read only, unmapped on destruction
+		class mapped_file {
+		 public:
+			explicit mapped_file(std::filesystem::path const& path) {
+				auto const fd = ::open(path.c_str(), O_RDONLY);
+				if (fd < 0) {
+					throw std::runtime_error("Cannot call gdwg::load_mmap on a file that can't be opened");
+				}
+				struct stat info = {};
+				if (::fstat(fd, &info) != 0) {
+					::close(fd);
+					throw std::runtime_error("Cannot call gdwg::load_mmap on a file that can't be opened");
+				}
+				size_ = static_cast<std::size_t>(info.st_size);
+				if (size_ > 0) {
+					auto* const data = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+					if (data == MAP_FAILED) {
+						::close(fd);
+						throw std::runtime_error("Cannot call gdwg::load_mmap on a file that can't be mapped");
+					}
+					data_ = static_cast<std::byte const*>(data);
+				}
+				::close(fd);
+			}
+
+			mapped_file(mapped_file&& other) noexcept
+			: data_(std::exchange(other.data_, nullptr))
+			, size_(std::exchange(other.size_, 0)) {}
+
+			auto operator=(mapped_file&& other) noexcept -> mapped_file& {
+				if (this != &other) {
+					unmap();
+					data_ = std::exchange(other.data_, nullptr);
+					size_ = std::exchange(other.size_, 0);
+				}
+				return *this;
+			}
+
+			mapped_file(mapped_file const&) = delete;
+			auto operator=(mapped_file const&) -> mapped_file& = delete;
+
+			~mapped_file() {
+				unmap();
+			}
+
+			[[nodiscard]] auto bytes() const -> std::span<std::byte const> {
+				return {data_, size_};
+			}
+
+		 private:
+			auto unmap() noexcept -> void {
+				if (data_ != nullptr) {
+					::munmap(const_cast<std::byte*>(data_), size_);
+				}
+			}
+
+			std::byte const* data_ = nullptr;
+			std::size_t size_ = 0;
+		};
+
+		struct name_hash {
+			using is_transparent = void;
+			auto operator()(std::string_view name) const -> std::size_t {
+				return std::hash<std::string_view>{}(name);
+			}
+		};
+
+		// Node id based access to a graph under construction, for readers that resolve
+		// every name themselves, so the graph never has to look one up again
+		struct graph_builder {
+			// adds a node that isn't in g yet, returns its id
+			template<typename Graph, typename N>
+			static auto add_node(Graph& g, N const& value) -> node_id {
+				return g.add_node(value);
+			}
+
+			// an empty batch of (src id, dst id, weight) edges for g
+			template<typename Graph>
+			static auto edge_batch(Graph const&) -> std::vector<typename Graph::edge_record> {
+				return {};
+			}
+
+			// adds edges between ids of g, returns how many were new
+			template<typename Graph>
+			static auto insert_edges(Graph& g, std::vector<typename Graph::edge_record> edges) -> std::size_t {
+				return g.insert_records(std::move(edges));
+			}
+		};
+
+		// a node name and its id in the graph being read
+		using name_entry = std::pair<std::string const, node_id>;
+
+		// Node names seen so far, each added to the graph once, found by string_view
+		// without a copy
+		template<typename Graph>
+		class name_table {
+		 public:
+			explicit name_table(Graph& g)
+			: graph_(g) {}
+
+			auto intern(std::string_view name) -> name_entry const& {
+				auto const it = ids_.find(name);
+				if (it != ids_.end()) {
+					return *it;
+				}
+				auto const id = graph_builder::add_node(graph_, std::string(name));
+				return *ids_.emplace(name, id).first;
+			}
+
+			[[nodiscard]] auto size() const -> std::size_t {
+				return ids_.size();
+			}
+
+		 private:
+			Graph& graph_;
+			// node based, so the entries never move
+			std::unordered_map<std::string, node_id, name_hash, std::equal_to<>> ids_;
+		};
+
+		// Calls f with every line of in, without its newline. Reads chunk bytes at a
+		// time and only moves the unfinished last line of a chunk, the buffer only grows
+		// for a line longer than itself. Throws if the stream reports an I/O error.
+		template<typename F>
+		auto for_each_line(std::istream& in, std::size_t chunk, F f) -> void {
+			auto buffer = std::vector<char>(chunk);
+			auto kept = std::size_t{0};
+			for (;;) {
+				if (kept == buffer.size()) {
+					buffer.resize(buffer.size() * 2);
+				}
+				in.read(buffer.data() + kept, static_cast<std::streamsize>(buffer.size() - kept));
+				// an I/O error is not the end of the input, the graph would come back cut short
+				if (in.bad()) {
+					throw std::runtime_error("Cannot call gdwg::read_graph on a stream that fails while reading");
+				}
+				auto const end = kept + static_cast<std::size_t>(in.gcount());
+				auto first = std::size_t{0};
+				for (;;) {
+					auto const* const newline = static_cast<char const*>(
+					    std::memchr(buffer.data() + first, '\n', end - first));
+					if (newline == nullptr) {
+						break;
+					}
+					auto const last = static_cast<std::size_t>(newline - buffer.data());
+					f(std::string_view(buffer.data() + first, last - first));
+					first = last + 1;
+				}
+				if (!in) {
+					if (first < end) {
+						f(std::string_view(buffer.data() + first, end - first));
+					}
+					return;
+				}
+				std::memmove(buffer.data(), buffer.data() + first, end - first);
+				kept = end - first;
+			}
+		}
+
+		template<typename E>
+		auto parse_weight(std::string_view text) -> std::optional<E> {
+			auto weight = E{};
+			auto const [end, error] = std::from_chars(text.data(), text.data() + text.size(), weight);
+			if (error != std::errc() || end != text.data() + text.size()) {
+				return std::nullopt;
+			}
+			return weight;
+		}
+
+		// One line of operator<< output. A block is "src (", edge lines, then ")", and an
+		// edge line is "  src -> dst | U" or "  src -> dst | W | weight". src is known
+		// from the block and the suffix is matched from the right, so names may hold
+		// spaces, arrows or bars.
+		template<typename E>
+		class dump_parser {
+		 public:
+			template<typename Names, typename Emit>
+			auto line(std::string_view text, Names& names, Emit emit) -> bool {
+				if (!src_) {
+					if (text.empty()) {
+						return true;
+					}
+					if (!text.ends_with(" (")) {
+						return false;
+					}
+					src_ = &names.intern(text.substr(0, text.size() - 2));
+					return true;
+				}
+				if (text == ")") {
+					src_ = nullptr;
+					return true;
+				}
+				auto const src = std::string_view(src_->first);
+				if (!text.starts_with("  ") || text.substr(2, src.size()) != src
+				    || text.substr(2 + src.size(), 4) != " -> ")
+				{
+					return false;
+				}
+				auto const rest = text.substr(src.size() + 6);
+				if (rest.ends_with(" | U")) {
+					emit(*src_, rest.substr(0, rest.size() - 4), std::nullopt);
+					return true;
+				}
+				auto const bar = rest.rfind(" | W | ");
+				if (bar == std::string_view::npos) {
+					return false;
+				}
+				auto const weight = parse_weight<E>(rest.substr(bar + 7));
+				if (!weight) {
+					return false;
+				}
+				emit(*src_, rest.substr(0, bar), weight);
+				return true;
+			}
+
+			// false while a block is still open
+			[[nodiscard]] auto finished() const -> bool {
+				return src_ == nullptr;
+			}
+
+		 private:
+			name_entry const* src_ = nullptr;
+		};
+
+		// "src dst" or "src dst weight" split on spaces or tabs, blank and # lines skipped
+		template<typename E, typename Names, typename Emit>
+		auto edge_list_line(std::string_view text, Names& names, Emit emit) -> bool {
+			auto fields = std::array<std::string_view, 4>();
+			auto count = std::size_t{0};
+			auto at = std::size_t{0};
+			while (count < fields.size()) {
+				at = text.find_first_not_of(" \t", at);
+				if (at == std::string_view::npos || text[at] == '#') {
+					break;
+				}
+				auto const end = std::min(text.find_first_of(" \t", at), text.size());
+				fields[count++] = text.substr(at, end - at);
+				at = end;
+			}
+			if (count == 0) {
+				return true;
+			}
+			if (count == 1 || count == 4) {
+				return false;
+			}
+			auto weight = std::optional<E>();
+			if (count == 3) {
+				weight = parse_weight<E>(fields[2]);
+				if (!weight) {
+					return false;
+				}
+			}
+			emit(names.intern(fields[0]), fields[1], weight);
+			return true;
+		}
+
+		template<typename E, typename Index>
+		auto read_text(std::istream& in, bool dump, std::size_t chunk) -> graph<std::string, E, Index> {
+			using result_type = graph<std::string, E, Index>;
+			auto result = result_type();
+			// every name goes into the graph when first seen, edges carry the ids
+			auto names = name_table<result_type>(result);
+			auto edges = graph_builder::edge_batch(result);
+			auto emit = [&](name_entry const& src, std::string_view dst, std::optional<E> weight) {
+				edges.push_back({src.second, names.intern(dst).second, weight});
+			};
+			// a dump names its nodes by their blocks, so every name used needs one
+			auto blocks = std::vector<bool>();
+			auto parser = dump_parser<E>();
+			auto number = std::size_t{0};
+			for_each_line(in, chunk, [&](std::string_view text) {
+				++number;
+				if (text.ends_with('\r')) {
+					text.remove_suffix(1);
+				}
+				auto const outside = parser.finished();
+				auto const ok = dump ? parser.line(text, names, emit) : edge_list_line<E>(text, names, emit);
+				if (!ok) {
+					throw std::runtime_error("Cannot call gdwg::read_graph on malformed input at line "
+					                         + std::to_string(number));
+				}
+				if (dump && outside && !parser.finished()) {
+					auto const id = names.intern(text.substr(0, text.size() - 2)).second;
+					if (blocks.size() <= id) {
+						blocks.resize(id + std::size_t{1});
+					}
+					blocks[id] = true;
+				}
+			});
+			if (!parser.finished()) {
+				throw std::runtime_error("Cannot call gdwg::read_graph on input that ends inside a node block");
+			}
+			if (dump && static_cast<std::size_t>(std::count(blocks.begin(), blocks.end(), true)) != names.size()) {
+				throw std::runtime_error("Cannot call gdwg::read_graph on a dump with an edge to a node without a "
+				                         "block");
+			}
+			graph_builder::insert_edges(result, std::move(edges));
+			return result;
+		}
+	} // namespace detail
+
+	///////////////////////////////////////////
+	//*********    Mapped Graph    **********//
+	///////////////////////////////////////////
+
+	// Read-only graph served straight from a file written by gdwg::save. Nothing is
+	// parsed or copied on load, node names are string_views into the mapping and the
+	// queries are the csr_graph ones over the mapped arrays. Ids follow sorted node
+	// order as in csr_graph.
+	template<typename E>
+	    requires detail::is_file_weight_v<E>
+	class mapped_graph {
+	 public:
+		explicit mapped_graph(std::filesystem::path const& path, bool verify = true)
+		: file_(path) {
+			auto const bytes = file_.bytes();
+			auto header = detail::file_header{};
+			if (bytes.size() < sizeof(header)) {
+				throw std::runtime_error("Cannot call gdwg::load_mmap on a file that isn't a gdwg graph");
+			}
+			std::memcpy(&header, bytes.data(), sizeof(header));
+			if (header.magic != detail::file_magic || header.version != detail::file_version
+			    || header.header_checksum != detail::header_checksum(header))
+			{
+				throw std::runtime_error("Cannot call gdwg::load_mmap on a file that isn't a gdwg graph");
+			}
+			if (header.byte_order != 0x01020304u || header.weight_size != sizeof(E)
+			    || header.weight_kind != detail::weight_kind<E>())
+			{
+				throw std::runtime_error("Cannot call gdwg::load_mmap on a file written for another byte order or "
+				                         "weight type");
+			}
+			// counts bound by the file size first, so the section sizes can't overflow
+			if (header.node_count >= std::numeric_limits<node_id>::max() || header.node_count > bytes.size()
+			    || header.edge_count > bytes.size() || header.name_bytes > bytes.size())
+			{
+				throw std::runtime_error("Cannot call gdwg::load_mmap on a file that is truncated");
+			}
+			auto const sizes = detail::section_sizes(header);
+			auto sections = std::array<std::span<std::byte const>, detail::file_sections>();
+			auto at = std::uint64_t{sizeof(header)};
+			for (auto s = std::size_t{0}; s < detail::file_sections; ++s) {
+				if (at + sizes[s] > bytes.size()) {
+					throw std::runtime_error("Cannot call gdwg::load_mmap on a file that is truncated");
+				}
+				sections[s] = bytes.subspan(at, sizes[s]);
+				if (verify && detail::checksum(sections[s]) != header.checksums[s]) {
+					throw std::runtime_error("Cannot call gdwg::load_mmap on a file that fails its checksum");
+				}
+				at += detail::padded(sizes[s]);
+			}
+
+			auto const n = header.node_count;
+			auto const m = header.edge_count;
+			name_offsets_ = as<std::uint64_t>(sections[0], n + 1);
+			names_ = std::string_view(reinterpret_cast<char const*>(sections[1].data()), sections[1].size());
+			offsets_ = as<std::uint64_t>(sections[2], n + 1);
+			targets_ = as<node_id>(sections[3], m);
+			weighted_ = as<std::uint8_t>(sections[4], m);
+			weights_ = as<E>(sections[5], m);
+			in_offsets_ = as<std::uint64_t>(sections[6], n + 1);
+			sources_ = as<node_id>(sections[7], m);
+			check_structure();
+		}
+
+		////////////////////
+		////  Accessors ////
+		////////////////////
+
+		[[nodiscard]] auto is_node(std::string_view value) const -> bool {
+			return index_of(value).has_value();
+		}
+
+		[[nodiscard]] auto empty() const -> bool {
+			return node_count() == 0;
+		}
+
+		[[nodiscard]] auto is_connected(std::string_view src, std::string_view dst) const -> bool {
+			auto const s = index_of(src);
+			auto const d = index_of(dst);
+			if (!s || !d) {
+				throw std::runtime_error("Cannot call gdwg::mapped_graph<E>::is_connected if src or dst node don't "
+				                         "exist in the graph");
+			}
+			auto const targets = out_targets(*s);
+			return std::binary_search(targets.begin(), targets.end(), *d);
+		}
+
+		[[nodiscard]] auto nodes() const -> std::vector<std::string_view> {
+			auto result = std::vector<std::string_view>();
+			result.reserve(node_count());
+			for (auto id = node_id{0}; id < node_count(); ++id) {
+				result.push_back(node_at(id));
+			}
+			return result;
+		}
+
+		// weights of the src -> dst edges, unweighted first then ascending
+		[[nodiscard]] auto weights(std::string_view src, std::string_view dst) const
+		    -> std::vector<std::optional<E>> {
+			auto const s = index_of(src);
+			auto const d = index_of(dst);
+			if (!s || !d) {
+				throw std::runtime_error("Cannot call gdwg::mapped_graph<E>::weights if src or dst node don't exist "
+				                         "in the graph");
+			}
+			auto const targets = out_targets(*s);
+			auto const [first, last] = std::equal_range(targets.begin(), targets.end(), *d);
+			auto result = std::vector<std::optional<E>>();
+			for (auto e = offsets_[*s] + static_cast<std::size_t>(first - targets.begin());
+			     e < offsets_[*s] + static_cast<std::size_t>(last - targets.begin());
+			     ++e)
+			{
+				result.push_back(weight(e));
+			}
+			return result;
+		}
+
+		[[nodiscard]] auto connections(std::string_view src) const -> std::vector<std::string_view> {
+			auto const s = index_of(src);
+			if (!s) {
+				throw std::runtime_error("Cannot call gdwg::mapped_graph<E>::connections if src doesn't exist in the "
+				                         "graph");
+			}
+			auto const out = out_targets(*s);
+			auto const in = in_sources(*s);
+			std::vector<node_id> ids;
+			std::set_union(out.begin(), out.end(), in.begin(), in.end(), std::back_inserter(ids));
+			ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+			std::vector<std::string_view> connected_nodes;
+			connected_nodes.reserve(ids.size());
+			for (auto const id : ids) {
+				connected_nodes.push_back(node_at(id));
+			}
+			return connected_nodes;
+		}
+
+		// a regular graph holding a copy of everything in the file
+		[[nodiscard]] auto to_graph() const -> graph<std::string, E> {
+			auto result = graph<std::string, E>();
+			for (auto id = node_id{0}; id < node_count(); ++id) {
+				result.insert_node(std::string(node_at(id)));
+			}
+			auto edges = std::vector<std::tuple<std::string, std::string, std::optional<E>>>();
+			edges.reserve(edge_count());
+			for (auto id = node_id{0}; id < node_count(); ++id) {
+				for (auto e = offsets_[id]; e < offsets_[id + 1]; ++e) {
+					edges.emplace_back(node_at(id), node_at(targets_[e]), weight(e));
+				}
+			}
+			result.insert_edges(edges);
+			return result;
+		}
+
+		//////////////////////////////
+		////  Dense Index Access  ////
+		//////////////////////////////
+
+		[[nodiscard]] auto node_count() const -> std::size_t {
+			return offsets_.size() - 1;
+		}
+
+		[[nodiscard]] auto edge_count() const -> std::size_t {
+			return targets_.size();
+		}
+
+		[[nodiscard]] auto index_of(std::string_view value) const -> std::optional<node_id> {
+			auto low = std::size_t{0};
+			auto high = node_count();
+			while (low < high) {
+				auto const mid = low + (high - low) / 2;
+				if (node_at(static_cast<node_id>(mid)) < value) {
+					low = mid + 1;
+				}
+				else {
+					high = mid;
+				}
+			}
+			if (low == node_count() || node_at(static_cast<node_id>(low)) != value) {
+				return std::nullopt;
+			}
+			return static_cast<node_id>(low);
+		}
+
+		[[nodiscard]] auto node_at(node_id id) const -> std::string_view {
+			return names_.substr(name_offsets_[id], name_offsets_[id + 1] - name_offsets_[id]);
+		}
+
+		[[nodiscard]] auto out_targets(node_id id) const -> std::span<node_id const> {
+			return targets_.subspan(offsets_[id], offsets_[id + 1] - offsets_[id]);
+		}
+
+		[[nodiscard]] auto in_sources(node_id id) const -> std::span<node_id const> {
+			return sources_.subspan(in_offsets_[id], in_offsets_[id + 1] - in_offsets_[id]);
+		}
+
+		// weight of the e-th edge in csr order
+		[[nodiscard]] auto weight(std::size_t e) const -> std::optional<E> {
+			if (weighted_[e] == 0) {
+				return std::nullopt;
+			}
+			return weights_[e];
+		}
+
+	 private:
+		// Every offset and id is checked once on load, checksums or not, so no query can
+		// index past the mapping whatever the file holds. One pass over the offsets and
+		// ids, names and weights are not looked at.
+		auto check_structure() const -> void {
+			auto const n = offsets_.size() - 1;
+			auto runs = [](std::span<std::uint64_t const> offsets, std::uint64_t total) {
+				return offsets.front() == 0 && offsets.back() == total
+				       && std::is_sorted(offsets.begin(), offsets.end());
+			};
+			auto ids = [&](std::span<node_id const> values) {
+				return std::all_of(values.begin(), values.end(), [&](node_id id) { return id < n; });
+			};
+			if (!runs(name_offsets_, names_.size()) || !runs(offsets_, targets_.size())
+			    || !runs(in_offsets_, sources_.size()) || !ids(targets_) || !ids(sources_))
+			{
+				throw std::runtime_error("Cannot call gdwg::load_mmap on a file with offsets or ids out of range");
+			}
+		}
+
+		// sections are 8 byte aligned in a page aligned mapping and E needs no more than
+		// that, so the cast is aligned
+		template<typename T>
+		static auto as(std::span<std::byte const> section, std::uint64_t count) -> std::span<T const> {
+			return {reinterpret_cast<T const*>(section.data()), static_cast<std::size_t>(count)};
+		}
+
+		detail::mapped_file file_;
+		std::span<std::uint64_t const> name_offsets_;
+		std::string_view names_;
+		std::span<std::uint64_t const> offsets_;
+		std::span<node_id const> targets_;
+		std::span<std::uint8_t const> weighted_;
+		std::span<E const> weights_;
+		std::span<std::uint64_t const> in_offsets_;
+		std::span<node_id const> sources_;
+	};
+
+	///////////////////////////////////////////
+	//*********    Binary Format    *********//
+	///////////////////////////////////////////
+
+	// Write g in the binary format read by load_mmap, throws if the file can't be written
+	template<typename E, typename Index>
+	    requires detail::is_file_weight_v<E>
+	auto save(graph<std::string, E, Index> const& g, std::filesystem::path const& path) -> void {
+		auto const csr = g.freeze();
+		auto const n = csr.node_count();
+		auto const m = csr.edge_count();
+
+		auto name_offsets = std::vector<std::uint64_t>{0};
+		auto names = std::string();
+		auto offsets = std::vector<std::uint64_t>{0};
+		auto targets = std::vector<node_id>();
+		auto weighted = std::vector<std::uint8_t>();
+		auto weights = std::vector<E>();
+		auto in_offsets = std::vector<std::uint64_t>{0};
+		auto sources = std::vector<node_id>();
+		targets.reserve(m);
+		weighted.reserve(m);
+		weights.reserve(m);
+		sources.reserve(m);
+		for (auto id = node_id{0}; id < n; ++id) {
+			names += csr.node_at(id);
+			name_offsets.push_back(names.size());
+			auto const out = csr.out_targets(id);
+			targets.insert(targets.end(), out.begin(), out.end());
+			for (auto const& w : csr.out_weights(id)) {
+				weighted.push_back(w ? 1 : 0);
+				weights.push_back(w.value_or(E{}));
+			}
+			offsets.push_back(targets.size());
+			auto const in = csr.in_sources(id);
+			sources.insert(sources.end(), in.begin(), in.end());
+			in_offsets.push_back(sources.size());
+		}
+
+		auto const sections = std::array<std::span<std::byte const>, detail::file_sections>{
+		    std::as_bytes(std::span(name_offsets)),
+		    std::as_bytes(std::span(names)),
+		    std::as_bytes(std::span(offsets)),
+		    std::as_bytes(std::span(targets)),
+		    std::as_bytes(std::span(weighted)),
+		    std::as_bytes(std::span(weights)),
+		    std::as_bytes(std::span(in_offsets)),
+		    std::as_bytes(std::span(sources)),
+		};
+		auto header = detail::file_header{};
+		header.magic = detail::file_magic;
+		header.version = detail::file_version;
+		header.byte_order = 0x01020304u;
+		header.weight_size = sizeof(E);
+		header.weight_kind = detail::weight_kind<E>();
+		header.node_count = n;
+		header.edge_count = m;
+		header.name_bytes = names.size();
+		for (auto s = std::size_t{0}; s < detail::file_sections; ++s) {
+			header.checksums[s] = detail::checksum(sections[s]);
+		}
+		header.header_checksum = detail::header_checksum(header);
+
+		auto out = std::ofstream(path, std::ios::binary | std::ios::trunc);
+		auto write = [&](std::span<std::byte const> bytes) {
+			out.write(reinterpret_cast<char const*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+			auto const zeros = std::array<char, 8>{};
+			out.write(zeros.data(), static_cast<std::streamsize>(detail::padded(bytes.size()) - bytes.size()));
+		};
+		write(std::as_bytes(std::span(&header, 1)));
+		for (auto const& section : sections) {
+			write(section);
+		}
+		if (!out.flush()) {
+			throw std::runtime_error("Cannot call gdwg::save on a file that can't be written");
+		}
+	}
+
+	// Map a file written by gdwg::save. With verify every section is checked against
+	// its checksum, which reads the whole file once. verify = false skips only the
+	// checksums: the header, section sizes and every offset and id are still checked,
+	// in one linear pass over the offset and id arrays.
+	template<typename E>
+	    requires detail::is_file_weight_v<E>
+	auto load_mmap(std::filesystem::path const& path, bool verify = true) -> mapped_graph<E> {
+		return mapped_graph<E>(path, verify);
+	}
+
+	///////////////////////////////////////////
+	//**********    Text Formats    *********//
+	///////////////////////////////////////////
+
+	enum class text_format {
+		// what operator<< writes
+		dump,
+		// a "src dst" or "src dst weight" line per edge, nodes are the names used
+		edge_list,
+	};
+
+	// Read a graph back from text. The input is read in large chunks, each name is
+	// added to the graph when first seen and every edge goes into one batch by node
+	// id, so a line costs a scan and a hash lookup per name. Throws with the line
+	// number on malformed input.
+	template<typename E, typename Index = ordered_index>
+	    requires std::is_arithmetic_v<E>
+	auto read_graph(std::istream& in, text_format format = text_format::dump) -> graph<std::string, E, Index> {
+		return detail::read_text<E, Index>(in, format == text_format::dump, std::size_t{1} << 20);
+	}
+
+	template<typename E, typename Index = ordered_index>
+	    requires std::is_arithmetic_v<E>
+	auto read_graph(std::filesystem::path const& path, text_format format = text_format::dump)
+	    -> graph<std::string, E, Index> {
+		auto in = std::ifstream(path, std::ios::binary);
+		if (!in) {
+			throw std::runtime_error("Cannot call gdwg::read_graph on a file that can't be opened");
+		}
+		return read_graph<E, Index>(in, format);
+	}
+} // namespace gdwg
+
+#endif // GDWG_GRAPH_IO_H
@@ -0,0 +1,225 @@
+#include "gdwg_graph_io.h"
+
+#include <catch2/catch.hpp>
+
+#include <random>
+#include <sstream>
+
+using namespace gdwg;
+
+namespace {
+	// a file in the temp directory, removed when the test is done with it
+	struct temp_file {
+		explicit temp_file(std::string const& name)
+		: path(std::filesystem::temp_directory_path() / ("gdwg_" + std::to_string(::getpid()) + "_" + name)) {}
+
+		temp_file(temp_file const&) = delete;
+		auto operator=(temp_file const&) -> temp_file& = delete;
+
+		~temp_file() {
+			std::filesystem::remove(path);
+		}
+
+		std::filesystem::path path;
+	};
+
+	// hands out text, then fails like a device error instead of reaching the end
+	class failing_buffer : public std::streambuf {
+	 public:
+		explicit failing_buffer(std::string text)
+		: text_(std::move(text)) {}
+
+	 protected:
+		auto underflow() -> int_type override {
+			if (served_) {
+				throw std::ios_base::failure("read error");
+			}
+			served_ = true;
+			setg(text_.data(), text_.data(), text_.data() + text_.size());
+			return traits_type::to_int_type(text_.front());
+		}
+
+	 private:
+		std::string text_;
+		bool served_ = false;
+	};
+} // namespace
+
+TEST_CASE("Test Binary Format: Save And Map") {
+	auto g = gdwg::graph<std::string, int>{"a", "b", "c", "d"};
+	g.insert_edge("a", "b", 3);
+	g.insert_edge("a", "b");
+	g.insert_edge("a", "b", -1);
+	g.insert_edge("c", "a", 2);
+	g.insert_edge("d", "d", 4);
+	auto const file = temp_file("small.gdwg");
+	gdwg::save(g, file.path);
+
+	auto const mapped = gdwg::load_mmap<int>(file.path);
+	REQUIRE(mapped.node_count() == 4);
+	REQUIRE(mapped.edge_count() == 5);
+	REQUIRE(mapped.nodes() == std::vector<std::string_view>{"a", "b", "c", "d"});
+	REQUIRE(mapped.is_node("c"));
+	REQUIRE_FALSE(mapped.is_node("e"));
+	REQUIRE(mapped.is_connected("a", "b"));
+	REQUIRE_FALSE(mapped.is_connected("b", "a"));
+	REQUIRE(mapped.weights("a", "b") == std::vector<std::optional<int>>{std::nullopt, -1, 3});
+	REQUIRE(mapped.connections("a") == std::vector<std::string_view>{"b", "c"});
+	REQUIRE_THROWS_AS(mapped.is_connected("a", "e"), std::runtime_error);
+	REQUIRE(mapped.to_graph() == g);
+
+	SECTION("Empty graph") {
+		auto const empty = temp_file("empty.gdwg");
+		gdwg::save(gdwg::graph<std::string, double>{}, empty.path);
+		REQUIRE(gdwg::load_mmap<double>(empty.path).empty());
+		// mapped weights can't need more than the 8 byte section alignment
+		STATIC_REQUIRE(gdwg::detail::is_file_weight_v<double>);
+		STATIC_REQUIRE_FALSE(gdwg::detail::is_file_weight_v<long double>);
+	}
+	SECTION("Bad files are refused") {
+		REQUIRE_THROWS_AS(gdwg::load_mmap<long>(file.path), std::runtime_error);
+		REQUIRE_THROWS_AS(gdwg::load_mmap<unsigned>(file.path), std::runtime_error);
+		REQUIRE_THROWS_AS(gdwg::load_mmap<int>(file.path.string() + ".missing"), std::runtime_error);
+
+		auto const size = std::filesystem::file_size(file.path);
+		auto const corrupt = temp_file("corrupt.gdwg");
+		auto overwrite = [&](std::uint64_t at) {
+			std::filesystem::copy_file(file.path, corrupt.path, std::filesystem::copy_options::overwrite_existing);
+			auto stream = std::fstream(corrupt.path, std::ios::binary | std::ios::in | std::ios::out);
+			stream.seekp(static_cast<std::streamoff>(at));
+			stream.put('\x7f');
+		};
+		// a weight byte: the header, then padded name offsets, names, out offsets,
+		// targets and weighted flags for 4 nodes and 5 edges
+		overwrite(sizeof(gdwg::detail::file_header) + 40 + 8 + 40 + 24 + 8);
+		REQUIRE_THROWS_AS(gdwg::load_mmap<int>(corrupt.path), std::runtime_error);
+		REQUIRE(gdwg::load_mmap<int>(corrupt.path, false).weights("a", "b").size() == 3);
+
+		// the last source id, the final 4 bytes are padding. Out of range even unverified.
+		overwrite(size - 8);
+		REQUIRE_THROWS_WITH(gdwg::load_mmap<int>(corrupt.path, false),
+		                    "Cannot call gdwg::load_mmap on a file with offsets or ids out of range");
+
+		// the last out offset, which must equal the edge count
+		overwrite(sizeof(gdwg::detail::file_header) + 40 + 8 + 32);
+		REQUIRE_THROWS_AS(gdwg::load_mmap<int>(corrupt.path, false), std::runtime_error);
+
+		std::filesystem::resize_file(corrupt.path, size / 2);
+		REQUIRE_THROWS_AS(gdwg::load_mmap<int>(corrupt.path, false), std::runtime_error);
+	}
+}
+
+TEST_CASE("Test Binary Format: Round Trip") {
+	auto g = gdwg::graph<std::string, double>{};
+	auto const n = 2000;
+	for (auto i = 0; i < n; ++i) {
+		g.insert_node("node " + std::to_string(i));
+	}
+	auto rng = std::mt19937{31};
+	auto pick = std::uniform_int_distribution<int>(0, n - 1);
+	auto weight = std::uniform_real_distribution<double>(-5.0, 5.0);
+	auto edges = std::vector<std::tuple<std::string, std::string, std::optional<double>>>();
+	for (auto i = 0; i < 10 * n; ++i) {
+		auto w = i % 7 == 0 ? std::nullopt : std::optional<double>(weight(rng));
+		edges.emplace_back("node " + std::to_string(pick(rng)), "node " + std::to_string(pick(rng)), w);
+	}
+	g.insert_edges(edges);
+	auto const file = temp_file("random.gdwg");
+	gdwg::save(g, file.path);
+
+	auto const mapped = gdwg::load_mmap<double>(file.path);
+	auto const csr = g.freeze();
+	REQUIRE(mapped.edge_count() == csr.edge_count());
+	for (auto id = gdwg::node_id{0}; id < csr.node_count(); ++id) {
+		REQUIRE(mapped.node_at(id) == csr.node_at(id));
+		REQUIRE(std::ranges::equal(mapped.out_targets(id), csr.out_targets(id)));
+		REQUIRE(std::ranges::equal(mapped.in_sources(id), csr.in_sources(id)));
+		auto const connected = csr.connections(csr.node_at(id));
+		REQUIRE(std::ranges::equal(mapped.connections(csr.node_at(id)), connected));
+	}
+	REQUIRE(mapped.to_graph() == g);
+}
+
+TEST_CASE("Test Text Formats: Dump") {
+	// names with spaces and arrows, and a node with no edges
+	auto g = gdwg::graph<std::string, int>{"a", "b c", "x -> y", "lonely"};
+	g.insert_edge("a", "b c", 5);
+	g.insert_edge("a", "b c");
+	g.insert_edge("a", "x -> y", -3);
+	g.insert_edge("x -> y", "a", 0);
+	g.insert_edge("b c", "b c", 12);
+	auto out = std::ostringstream();
+	out << g;
+
+	SECTION("Round trip") {
+		auto in = std::istringstream(out.str());
+		REQUIRE(gdwg::read_graph<int>(in) == g);
+		auto hashed = std::istringstream(out.str());
+		REQUIRE(gdwg::read_graph<int, gdwg::hashed_index>(hashed).nodes() == g.nodes());
+	}
+	SECTION("Chunks split lines anywhere") {
+		for (auto const chunk : {1, 3, 7, 64}) {
+			auto in = std::istringstream(out.str());
+			REQUIRE(gdwg::detail::read_text<int, gdwg::ordered_index>(in, true, static_cast<std::size_t>(chunk)) == g);
+		}
+	}
+	SECTION("Floating point weights") {
+		auto d = gdwg::graph<std::string, double>{"p", "q"};
+		d.insert_edge("p", "q", 2.5);
+		d.insert_edge("q", "p", -0.125);
+		auto text = std::ostringstream();
+		text << d;
+		auto in = std::istringstream(text.str());
+		REQUIRE(gdwg::read_graph<double>(in) == d);
+	}
+	SECTION("Malformed input") {
+		auto read = [](std::string const& text) {
+			auto in = std::istringstream(text);
+			return gdwg::read_graph<int>(in);
+		};
+		REQUIRE(read("").empty());
+		REQUIRE_THROWS_WITH(read("a (\n  a -> a | W | x\n)\n"),
+		                    "Cannot call gdwg::read_graph on malformed input at line 2");
+		REQUIRE_THROWS_AS(read("a (\n  b -> a | U\n)\n"), std::runtime_error);
+		REQUIRE_THROWS_AS(read("a\n"), std::runtime_error);
+		REQUIRE_THROWS_AS(read("a (\n  a -> a | U\n"), std::runtime_error);
+		// an edge to a node that has no block
+		REQUIRE_THROWS_WITH(read("a (\n  a -> b | U\n)\n"),
+		                    "Cannot call gdwg::read_graph on a dump with an edge to a node without a block");
+	}
+}
+
+TEST_CASE("Test Text Formats: Edge List") {
+	auto in = std::istringstream("# comment\na b 4\n\tb\tc\r\nc a -2 # trailing\n\nd d\n");
+	auto const g = gdwg::read_graph<long>(in, gdwg::text_format::edge_list);
+	auto expected = gdwg::graph<std::string, long>{"a", "b", "c", "d"};
+	expected.insert_edge("a", "b", 4);
+	expected.insert_edge("b", "c");
+	expected.insert_edge("c", "a", -2);
+	expected.insert_edge("d", "d");
+	REQUIRE(g == expected);
+
+	// whole lines came through before the error, yet the graph must not be returned
+	auto failing = failing_buffer("a b 1\nb c 2\nc");
+	auto broken = std::istream(&failing);
+	REQUIRE_THROWS_WITH(gdwg::read_graph<long>(broken, gdwg::text_format::edge_list),
+	                    "Cannot call gdwg::read_graph on a stream that fails while reading");
+
+	auto bad = std::istringstream("a b\na\n");
+	REQUIRE_THROWS_WITH(gdwg::read_graph<long>(bad, gdwg::text_format::edge_list),
+	                    "Cannot call gdwg::read_graph on malformed input at line 2");
+
+	SECTION("From a file") {
+		auto const file = temp_file("edges.txt");
+		{
+			auto out = std::ofstream(file.path);
+			for (auto i = 0; i < 50000; ++i) {
+				out << "n" << i % 1000 << ' ' << "n" << (i * 7) % 1000 << ' ' << i % 13 << '\n';
+			}
+		}
+		auto const big = gdwg::read_graph<int>(file.path, gdwg::text_format::edge_list);
+		REQUIRE(big.nodes().size() == 1000);
+		REQUIRE(big.is_connected("n1", "n7"));
+		REQUIRE_THROWS_AS(gdwg::read_graph<int>(file.path.string() + ".missing"), std::runtime_error);
+	}
+}